@@ -0,0 +1,224 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Packet framing round trip (host)
+ *
+ * Purpose: Host program checking the framing module for both framings and
+ *          every crc type: random frames, rich in delimiter and escape
+ *          characters, are encoded, concatenated into a stream and fed to
+ *          the streaming decoder by random chunks; each frame must be
+ *          delivered unchanged and in order. Corrupted frames must be
+ *          rejected when protected by a crc, and the crcs are checked
+ *          against their standard check values.
+ *
+ *          Build and run with:
+ *            gcc -O2 -Iinc bench/framing_roundtrip.c src/framing.c \
+ *                -o framing_roundtrip && ./framing_roundtrip [seed]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "framing.h"
+
+#define NB_FRAMES    2000
+#define NB_CORRUPTED 1000
+#define MAX_PAYLOAD  700  // beyond 254 to cover the long cobs blocks
+#define MAX_CHUNK    97
+#define STREAM_SIZE  (NB_FRAMES * FRAMING_MAX_SIZE(MAX_PAYLOAD))
+
+static const char* type_names[] = {"cobs", "slip"};
+static const char* crc_names[]  = {"none", "crc16", "crc32"};
+
+// frames sent, in order
+static struct frame {
+    uint8_t data[MAX_PAYLOAD];
+    size_t  len;
+} frames[NB_FRAMES];
+
+static uint8_t stream[STREAM_SIZE];
+static uint8_t rx_buf[MAX_PAYLOAD + 4];
+
+// delivery check state
+static struct {
+    size_t   next;       // index of the next expected frame
+    uint32_t received;   // frames delivered
+    uint32_t mismatch;   // frames delivered with a wrong content
+    bool     crc;        // empty payloads are delivered when protected
+} check;
+
+static uint32_t seed = 1;
+
+/* -------------------------------------------------------------------------- */
+
+static uint32_t random32(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/**
+ * method to draw a payload byte, the framing special characters are
+ * drawn much more often than the others
+ */
+static uint8_t random_byte(void) {
+    static const uint8_t specials[] = {0x00, 0xc0, 0xdb, 0xdc, 0xdd, 0xff};
+    uint32_t r = random32();
+    if ((r & 3) == 0) return specials[(r >> 2) % sizeof(specials)];
+    return r >> 8;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to skip the frames which are not delivered: without crc an empty
+ * payload gives an empty frame, which the decoder ignores
+ */
+static void skip_empty(void) {
+    while (!check.crc && (check.next < NB_FRAMES) &&
+           (frames[check.next].len == 0))
+        check.next++;
+}
+
+static void deliver(void* param, uint8_t* frame, size_t len) {
+    (void)param;
+    check.received++;
+
+    skip_empty();
+    if ((check.next >= NB_FRAMES) || (len != frames[check.next].len) ||
+        (memcmp(frame, frames[check.next].data, len) != 0)) {
+        check.mismatch++;
+        return;
+    }
+    check.next++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to encode all frames into the stream
+ *
+ * @return length of the stream
+ */
+static size_t encode_all(enum framing_types type, enum framing_crcs crc) {
+    size_t total = 0;
+    for (int i = 0; i < NB_FRAMES; i++) {
+        // one frame out of 8 is a long one
+        size_t len    = random32() % ((i % 8 == 0) ? MAX_PAYLOAD + 1 : 40);
+        frames[i].len = len;
+        for (size_t j = 0; j < len; j++) frames[i].data[j] = random_byte();
+
+        uint8_t* buf = stream + total;
+        memcpy(buf, frames[i].data, len);
+        size_t nb = framing_encode(type, crc, buf, len, FRAMING_MAX_SIZE(len));
+        if (nb == 0) return 0;
+        total += nb;
+    }
+    return total;
+}
+
+/**
+ * method to feed the stream to a decoder by random chunks
+ */
+static void decode_all(struct framing_decoder* dec, size_t total) {
+    for (size_t pos = 0; pos < total;) {
+        size_t nb = 1 + random32() % MAX_CHUNK;
+        if (nb > total - pos) nb = total - pos;
+        framing_decoder_push(dec, stream + pos, nb);
+        pos += nb;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool round_trip(enum framing_types type, enum framing_crcs crc) {
+    struct framing_decoder dec;
+    framing_decoder_init(&dec, type, crc, rx_buf, sizeof(rx_buf), deliver, 0);
+    memset(&check, 0, sizeof(check));
+    check.crc = crc != FRAMING_CRC_NONE;
+
+    size_t total = encode_all(type, crc);
+    if (total == 0) return false;
+    decode_all(&dec, total);
+
+    // all frames must have been delivered
+    skip_empty();
+    return (check.mismatch == 0) && (check.next == NB_FRAMES) &&
+           (dec.errors == 0);
+}
+
+/**
+ * method to send single frames with one byte of the encoded frame
+ * modified, the decoder must reject them. the crc-16 may let a frame
+ * through once in 65536 cases, hence the tolerance.
+ */
+static bool corrupted(enum framing_types type, enum framing_crcs crc) {
+    uint32_t undetected = 0;
+    for (int n = 0; n < NB_CORRUPTED; n++) {
+        struct framing_decoder dec;
+        framing_decoder_init(&dec, type, crc, rx_buf, sizeof(rx_buf),
+                             deliver, 0);
+        memset(&check, 0, sizeof(check));
+        check.crc = true;
+
+        size_t len    = 1 + random32() % 64;
+        frames[0].len = len;
+        for (size_t j = 0; j < len; j++) frames[0].data[j] = random_byte();
+
+        memcpy(stream, frames[0].data, len);
+        size_t total =
+            framing_encode(type, crc, stream, len, FRAMING_MAX_SIZE(len));
+        size_t pos = random32() % (total - 1);  // delimiter kept
+        stream[pos] ^= 1 + random32() % 255;
+        decode_all(&dec, total);
+
+        if (check.received != 0) undetected++;
+    }
+    printf("%-6s %-6s %u of %d corrupted frames undetected\n",
+           type_names[type], crc_names[crc], undetected, NB_CORRUPTED);
+    return undetected <= ((crc == FRAMING_CRC16) ? 2 : 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) seed = strtoul(argv[1], 0, 0);
+    if (seed == 0) seed = 1;
+    printf("framing round trip, %d frames, seed %u\n", NB_FRAMES, seed);
+
+    bool ok = (framing_crc16(0xffff, "123456789", 9) == 0x29b1) &&
+              (framing_crc32(0, "123456789", 9) == 0xcbf43926);
+    printf("%-6s %-6s %s\n", "-", "check", ok ? "ok" : "FAILED");
+
+    for (int type = FRAMING_COBS; type <= FRAMING_SLIP; type++) {
+        for (int crc = FRAMING_CRC_NONE; crc <= FRAMING_CRC32; crc++) {
+            bool passed = round_trip(type, crc);
+            printf("%-6s %-6s %s\n", type_names[type], crc_names[crc],
+                   passed ? "ok" : "FAILED");
+            if ((crc != FRAMING_CRC_NONE) && !corrupted(type, crc))
+                passed = false;
+            ok = ok && passed;
+        }
+    }
+
+    printf("%s\n", ok ? "all passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: kprintf benchmark
+ *
+ * Purpose: Bare-metal application comparing the cost in cpu cycles per call
+ *          of ksnprintf against newlib snprintf on a set of representative
+ *          format strings. Cycles are counted with the Cortex-A8 PMU cycle
+ *          counter and the results are reported on the console.
+ *          Build with KPRINTF_FLOAT to include the floating point case.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "am335x_console.h"
+#include "support.h"
+
+#define ITERATIONS 1000
+
+/* -------------------------------------------------------------------------- */
+
+static inline void pmu_init(void) {
+    // enable the counters and reset the cycle counter (PMCR.E, PMCR.C)
+    __asm__ volatile("mcr p15, 0, %0, c9, c12, 0" ::"r"((1 << 0) | (1 << 2)));
+    // enable the cycle counter (PMCNTENSET.C)
+    __asm__ volatile("mcr p15, 0, %0, c9, c12, 1" ::"r"(1u << 31));
+}
+
+static inline uint32_t pmu_cycles(void) {
+    uint32_t value;
+    __asm__ volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(value));
+    return value;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#define MEASURE(result, call)                                  \
+    do {                                                       \
+        uint32_t start = pmu_cycles();                         \
+        for (int i = 0; i < ITERATIONS; i++) call;             \
+        (result) = (pmu_cycles() - start) / ITERATIONS;        \
+    } while (0)
+
+static char buf[128];
+
+int main(void) {
+    am335x_console_init();
+    pmu_init();
+
+    uint32_t k;
+    uint32_t n;
+
+    kprintf("\nkprintf benchmark, cycles per call (%d iterations)\n",
+            ITERATIONS);
+    kprintf("%-28s %10s %10s\n", "format", "ksnprintf", "snprintf");
+
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "hello world"));
+    MEASURE(n, snprintf(buf, sizeof(buf), "hello world"));
+    kprintf("%-28s %10u %10u\n", "text", k, n);
+
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "%d", -123456));
+    MEASURE(n, snprintf(buf, sizeof(buf), "%d", -123456));
+    kprintf("%-28s %10u %10u\n", "%d", k, n);
+
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "%08x", 0xdeadbeef));
+    MEASURE(n, snprintf(buf, sizeof(buf), "%08x", 0xdeadbeef));
+    kprintf("%-28s %10u %10u\n", "%08x", k, n);
+
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "%llu", 18446744073709551615ULL));
+    MEASURE(n, snprintf(buf, sizeof(buf), "%llu", 18446744073709551615ULL));
+    kprintf("%-28s %10u %10u\n", "%llu", k, n);
+
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "%-10s|%5d|%p", "name", 42, buf));
+    MEASURE(n, snprintf(buf, sizeof(buf), "%-10s|%5d|%p", "name", 42, buf));
+    kprintf("%-28s %10u %10u\n", "%-10s|%5d|%p", k, n);
+
+#ifdef KPRINTF_FLOAT
+    MEASURE(k, ksnprintf(buf, sizeof(buf), "%.3f", 3.14159));
+    MEASURE(n, snprintf(buf, sizeof(buf), "%.3f", 3.14159));
+    kprintf("%-28s %10u %10u\n", "%.3f", k, n);
+#endif
+
+    while (1) {
+    }
+
+    return 0;
+}
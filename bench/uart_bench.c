@@ -0,0 +1,236 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: UART throughput and cpu cost benchmark
+ *
+ * Purpose: Bare-metal application measuring, for each baudrate and each
+ *          operating mode of the uart driver (polled, burst, interrupt and
+ *          dma), the throughput in bytes/s and the cpu time spent in the
+ *          driver in DMTimer1 ticks per byte. The controller runs in
+ *          internal loopback, so no wiring is required. Results are
+ *          reported on the console (UART0).
+ *          See uart_sim.c for the host variant counting register accesses.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "am335x_console.h"
+#include "am335x_dmtimer1.h"
+#include "am335x_edma.h"
+#include "am335x_irq.h"
+#include "am335x_uart.h"
+#include "support.h"
+
+#define TEST_UART   AM335X_UART1
+#define TEST_IRQ    SYS_INT_UART1INT
+#define NB_BYTES    4096
+#define DMA_CHUNK   256
+#define FIFO_WINDOW 32   // bytes in flight in polled modes (rx fifo is 64)
+#define RING_WINDOW 512  // bytes in flight in interrupt mode
+
+static const uint32_t baudrates[] = {
+    115200, 230400, 460800, 921600, 1000000, 1500000, 3000000, 3686400,
+};
+
+enum bench_modes { POLLED, BURST, INTERRUPT, DMA, NB_MODES };
+static const char* mode_names[] = {"polled", "burst", "interrupt", "dma"};
+
+struct result {
+    uint32_t ticks;  // total duration
+    uint32_t cpu;    // time spent in the driver
+    bool     ok;     // data received back unaltered
+};
+
+static uint8_t tx_buf[NB_BYTES] __attribute__((aligned(64)));
+static uint8_t rx_buf[NB_BYTES];
+static uint8_t dma_buf[2][DMA_CHUNK] __attribute__((aligned(64)));
+
+static volatile uint32_t isr_ticks;     // cpu time spent in interrupts
+static volatile size_t   dma_received;  // bytes delivered by the rx dma
+static uint32_t          deadline;      // maximum duration of a run
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t now(void) { return am335x_dmtimer1_get_counter(); }
+
+static inline bool expired(uint32_t start) { return now() - start > deadline; }
+
+static void uart_isr(void) {
+    uint32_t start = now();
+    am335x_uart_interrupt_handler(TEST_UART);
+    isr_ticks += now() - start;
+}
+
+static void edma_isr(void) {
+    uint32_t start = now();
+    am335x_edma_interrupt_handler();
+    isr_ticks += now() - start;
+}
+
+static void dma_rx_done(enum am335x_uart_controllers ctrl, void* buf,
+                        size_t len, void* param) {
+    (void)ctrl;
+    (void)param;
+    if (dma_received + len <= NB_BYTES)
+        memcpy(&rx_buf[dma_received], buf, len);
+    dma_received += len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void run_polled(struct result* r) {
+    size_t   tx    = 0;
+    size_t   rx    = 0;
+    uint32_t start = now();
+    while ((rx < NB_BYTES) && !expired(start)) {
+        if ((tx < NB_BYTES) && (tx - rx < FIFO_WINDOW))
+            am335x_uart_write(TEST_UART, tx_buf[tx++]);
+        if (am335x_uart_tstc(TEST_UART))
+            rx_buf[rx++] = am335x_uart_read(TEST_UART);
+    }
+    r->ticks = now() - start;
+    r->cpu   = r->ticks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void run_buffered(struct result* r, size_t window, bool busy) {
+    size_t   tx    = 0;
+    size_t   rx    = 0;
+    uint32_t cpu   = 0;
+    uint32_t start = now();
+    while ((rx < NB_BYTES) && !expired(start)) {
+        size_t room = window - (tx - rx);
+        if (room > NB_BYTES - tx) room = NB_BYTES - tx;
+        if (room > 0) {
+            uint32_t t  = now();
+            size_t   nb = am335x_uart_write_buf(TEST_UART, &tx_buf[tx], room);
+            if (nb > 0) cpu += now() - t;
+            tx += nb;
+        }
+        uint32_t t  = now();
+        size_t   nb = am335x_uart_read_buf(TEST_UART, &rx_buf[rx],
+                                         NB_BYTES - rx);
+        if (nb > 0) cpu += now() - t;
+        rx += nb;
+    }
+    r->ticks = now() - start;
+    r->cpu   = busy ? r->ticks : cpu + isr_ticks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void run_dma(struct result* r) {
+    struct am335x_uart_dma_request req = {
+        .buf = tx_buf, .len = NB_BYTES, .routine = 0, .param = 0,
+    };
+
+    dma_received   = 0;
+    uint32_t start = now();
+    am335x_uart_dma_start_read(TEST_UART, dma_buf[0], dma_buf[1], DMA_CHUNK,
+                               dma_rx_done, 0);
+    am335x_uart_dma_write(TEST_UART, &req);
+    uint32_t cpu = now() - start;
+    while ((dma_received < NB_BYTES) && !expired(start)) {
+    }
+    r->ticks = now() - start;
+    am335x_uart_dma_stop_read(TEST_UART);
+    r->cpu = cpu + isr_ticks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static int run(enum bench_modes mode, uint32_t baudrate, struct result* r) {
+    am335x_uart_init(TEST_UART);
+    if (am335x_uart_set_baudrate(TEST_UART, baudrate) != 0) return -1;
+    am335x_uart_set_loopback(TEST_UART, true);
+
+    memset(rx_buf, 0, sizeof(rx_buf));
+    isr_ticks = 0;
+
+    // allow three times the theoretical transfer time (10 bits/char)
+    uint64_t nominal = (uint64_t)NB_BYTES * 10 *
+                       am335x_dmtimer1_get_frequency() / baudrate;
+    deadline = nominal * 3;
+
+    switch (mode) {
+        case POLLED:
+            run_polled(r);
+            break;
+        case BURST:
+            run_buffered(r, FIFO_WINDOW, true);
+            break;
+        case INTERRUPT:
+            am335x_uart_set_mode(TEST_UART, AM335X_UART_INTERRUPT);
+            run_buffered(r, RING_WINDOW, false);
+            break;
+        case DMA:
+            am335x_uart_set_mode(TEST_UART, AM335X_UART_DMA);
+            run_dma(r);
+            break;
+        default:
+            return -1;
+    }
+    am335x_uart_set_mode(TEST_UART, AM335X_UART_POLLING);
+
+    r->ok = memcmp(tx_buf, rx_buf, NB_BYTES) == 0;
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    am335x_console_init();
+    am335x_dmtimer1_init();
+    am335x_edma_init();
+
+    IntAINTCInit();
+    IntRegister(TEST_IRQ, uart_isr);
+    IntRegister(SYS_INT_EDMACOMPINT, edma_isr);
+    IntSystemEnable(SYS_INT_EDMACOMPINT);
+    IntMasterIRQEnable();
+
+    for (int i = 0; i < NB_BYTES; i++) tx_buf[i] = i * 7 + (i >> 8);
+
+    kprintf("\nuart benchmark, %d bytes in internal loopback\n", NB_BYTES);
+    kprintf("%8s %-10s %10s %12s %s\n", "baud", "mode", "bytes/s",
+            "ticks/byte", "status");
+
+    for (unsigned b = 0; b < sizeof(baudrates) / sizeof(baudrates[0]); b++) {
+        for (int m = 0; m < NB_MODES; m++) {
+            struct result r = {0, 0, false};
+            if (run(m, baudrates[b], &r) != 0) {
+                kprintf("%8u %-10s %s\n", baudrates[b], mode_names[m],
+                        "unsupported baudrate");
+                continue;
+            }
+            uint32_t rate = (uint64_t)NB_BYTES *
+                            am335x_dmtimer1_get_frequency() / r.ticks;
+            uint32_t cost = (uint64_t)r.cpu * 100 / NB_BYTES;
+            kprintf("%8u %-10s %10u %9u.%02u %s\n", baudrates[b],
+                    mode_names[m], rate, cost / 100, cost % 100,
+                    r.ok ? "ok" : "FAILED");
+        }
+    }
+
+    while (1) {
+    }
+
+    return 0;
+}
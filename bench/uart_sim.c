@@ -0,0 +1,501 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: UART driver register access counter (host)
+ *
+ * Purpose: Host variant of uart_bench.c counting the number of register
+ *          accesses per byte done by the unmodified uart driver in polled,
+ *          burst and interrupt modes. The six uart register blocks are
+ *          mapped without access rights at their physical addresses; each
+ *          access traps, is accounted and emulated by a simple model of the
+ *          controller (64 bytes fifos, register banks, interrupt
+ *          identification, internal loopback). The line speed is expressed
+ *          in register accesses per character.
+ *          Busy-wait iterations, i.e. status register reads returning the
+ *          same value as the previous access to the same register, depend
+ *          on the line speed and not on the driver: they are reported apart
+ *          as polls, so that the access count only measures the driver.
+ *          In burst mode the cpu is busy elsewhere for half the window
+ *          between two bursts, so that the fifos are served by bursts as
+ *          the burst methods intend; the burst and interrupt modes must
+ *          then make fewer accesses per byte than the polled mode.
+ *
+ *          Linux x86-64 only, build with:
+ *            gcc -O2 -Iinc bench/uart_sim.c src/am335x_uart.c -o uart_sim
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "am335x_uart.h"
+
+#define TEST_UART  AM335X_UART1
+#define NB_BYTES   4096
+#define FIFO_SIZE  64
+#define PAGE_SIZE  0x1000
+#define TRAP_FLAG  0x100  // x86 eflags single step
+#define PF_WRITE   0x2    // page fault error code, write access
+
+#define FIFO_WINDOW 32
+#define RING_WINDOW 512
+
+static const uintptr_t uart_base[] = {
+    0x44e09000, 0x48022000, 0x48024000, 0x481a6000, 0x481a8000, 0x481aa000,
+};
+
+// a register access on the L4 interconnect takes roughly 100ns, so these
+// line speeds correspond to about 3.6Mbit/s, 921600 and 230400 bit/s
+static const uint32_t char_times[] = {27, 108, 434};
+
+enum bench_modes { POLLED, BURST, INTERRUPT, NB_MODES };
+static const char* mode_names[] = {"polled", "burst", "interrupt"};
+
+// register offsets
+#define RHR_THR_DLL 0x00
+#define IER_DLH     0x04
+#define IIR_FCR_EFR 0x08
+#define LCR         0x0c
+#define MCR         0x10
+#define LSR         0x14
+#define MSR_TCR     0x18
+#define SPR_TLR     0x1c
+#define SCR         0x40
+#define SSR         0x44
+#define SYSC        0x54
+#define SYSS        0x58
+#define RXFIFO_LVL  0x64
+#define TXFIFO_LVL  0x68
+
+// model of the test controller, the other ones are plain memory
+static struct model {
+    uint8_t  tx[FIFO_SIZE];
+    uint8_t  rx[FIFO_SIZE];
+    uint32_t tx_len;
+    uint32_t rx_head;
+    uint32_t rx_len;
+    bool     overrun;
+    uint32_t dll, dlh, ier, efr, fcr, lcr, mcr, tcr, tlr, spr, xon[4];
+    uint32_t regs[PAGE_SIZE / 4];  // registers without side effect
+
+    uint64_t now;        // time in register accesses
+    uint64_t next_char;  // time at which the next character is shifted
+    uint64_t last_rx;    // time of the last received character
+    uint32_t char_time;  // register accesses per character
+} m;
+
+// trap state
+static struct {
+    uint8_t* page;
+    uint32_t offset;
+    bool     write;
+    bool     model;
+} pending;
+
+static uint64_t accesses;
+static uint64_t polls;
+
+// last access to the test controller, to detect the status polls
+static struct {
+    uint32_t offset;
+    uint32_t value;
+    bool     read;
+} last;
+static bool     irq_enabled;
+
+/* -------------------------------------------------------------------------- */
+
+static void model_reset(void) {
+    uint32_t char_time = m.char_time;
+    memset(&m, 0, sizeof(m));
+    m.char_time = char_time;
+    m.lcr       = 0x03;
+}
+
+static inline bool mode_b(void) { return m.lcr == 0xbf; }
+static inline bool mode_a(void) { return (m.lcr & 0x80) != 0; }
+static inline bool tcr_tlr(void) {
+    return ((m.efr & 0x10) != 0) && ((m.mcr & 0x40) != 0);
+}
+
+static uint32_t rx_trigger(void) {
+    static const uint32_t fcr_levels[] = {8, 16, 56, 60};
+    if ((m.regs[SCR / 4] & 0x80) != 0) {
+        uint32_t t = ((m.tlr >> 4) << 2) | (m.fcr >> 6);
+        return t == 0 ? 1 : t;
+    }
+    if ((m.tlr >> 4) != 0) return (m.tlr >> 4) * 4;
+    return fcr_levels[(m.fcr >> 6) & 3];
+}
+
+static uint32_t tx_trigger(void) {
+    static const uint32_t fcr_spaces[] = {8, 16, 32, 56};
+    if ((m.tlr & 0xf) != 0) return (m.tlr & 0xf) * 4;
+    return fcr_spaces[(m.fcr >> 4) & 3];
+}
+
+static uint32_t iir_value(void) {
+    if (((m.ier & 0x04) != 0) && m.overrun) return 0x06;
+    if ((m.ier & 0x01) != 0) {
+        if (m.rx_len >= rx_trigger()) return 0x04;
+        if ((m.rx_len > 0) && (m.now - m.last_rx >= 4 * m.char_time))
+            return 0x0c;
+    }
+    if (((m.ier & 0x02) != 0) && (FIFO_SIZE - m.tx_len >= tx_trigger()))
+        return 0x02;
+    return 0x01;
+}
+
+static bool irq_pending(void) { return (iir_value() & 0x01) == 0; }
+
+/**
+ * method to advance the time by one register access and to shift the
+ * characters of the tx fifo into the rx fifo at the line speed
+ */
+static void model_tick(void) {
+    m.now++;
+    if (m.tx_len == 0) {
+        m.next_char = m.now + m.char_time;
+        return;
+    }
+    if (m.now < m.next_char) return;
+    m.next_char = m.now + m.char_time;
+
+    uint8_t c = m.tx[0];
+    memmove(m.tx, m.tx + 1, --m.tx_len);
+    if ((m.mcr & 0x10) == 0) return;  // no loopback, character lost
+    if (m.rx_len == FIFO_SIZE) {
+        m.overrun = true;
+        return;
+    }
+    m.rx[(m.rx_head + m.rx_len++) % FIFO_SIZE] = c;
+    m.last_rx = m.now;
+}
+
+/**
+ * method to emulate a register read, side effects included if consume is set
+ */
+static uint32_t model_read(uint32_t offset, bool consume) {
+    switch (offset) {
+        case RHR_THR_DLL:
+            if (mode_a()) return m.dll;
+            if (m.rx_len == 0) return 0;
+            if (!consume) return m.rx[m.rx_head];
+            uint8_t c = m.rx[m.rx_head];
+            m.rx_head = (m.rx_head + 1) % FIFO_SIZE;
+            m.rx_len--;
+            m.last_rx = m.now;
+            return c;
+        case IER_DLH:
+            return mode_a() ? m.dlh : m.ier;
+        case IIR_FCR_EFR:
+            return mode_b() ? m.efr : iir_value();
+        case LCR:
+            return m.lcr;
+        case MCR:
+            return mode_b() ? m.xon[0] : m.mcr;
+        case LSR: {
+            if (mode_b()) return m.xon[1];
+            uint32_t lsr = (m.rx_len > 0 ? 0x01 : 0) |
+                           (m.overrun ? 0x02 : 0) |
+                           (m.tx_len == 0 ? 0x60 : 0);
+            if (consume) m.overrun = false;
+            return lsr;
+        }
+        case MSR_TCR:
+            if (mode_b()) return m.xon[2];
+            return tcr_tlr() ? m.tcr : 0;
+        case SPR_TLR:
+            if (mode_b()) return m.xon[3];
+            return tcr_tlr() ? m.tlr : m.spr;
+        case SSR:
+            return m.tx_len == FIFO_SIZE ? 1 : 0;
+        case SYSS:
+            return 1;
+        case RXFIFO_LVL:
+            return m.rx_len;
+        case TXFIFO_LVL:
+            return m.tx_len;
+        default:
+            return m.regs[offset / 4];
+    }
+}
+
+static void model_write(uint32_t offset, uint32_t value) {
+    switch (offset) {
+        case RHR_THR_DLL:
+            if (mode_a())
+                m.dll = value;
+            else if (m.tx_len < FIFO_SIZE)
+                m.tx[m.tx_len++] = value;
+            break;
+        case IER_DLH:
+            if (mode_a())
+                m.dlh = value;
+            else
+                m.ier = value;
+            break;
+        case IIR_FCR_EFR:
+            if (mode_b()) {
+                m.efr = value;
+                break;
+            }
+            m.fcr = value;
+            if ((value & 0x02) != 0) m.rx_len = m.rx_head = 0;
+            if ((value & 0x04) != 0) m.tx_len = 0;
+            break;
+        case LCR:
+            m.lcr = value;
+            break;
+        case MCR:
+            if (mode_b())
+                m.xon[0] = value;
+            else
+                m.mcr = value;
+            break;
+        case LSR:
+            if (mode_b()) m.xon[1] = value;
+            break;
+        case MSR_TCR:
+            if (mode_b())
+                m.xon[2] = value;
+            else if (tcr_tlr())
+                m.tcr = value;
+            break;
+        case SPR_TLR:
+            if (mode_b())
+                m.xon[3] = value;
+            else if (tcr_tlr())
+                m.tlr = value;
+            else
+                m.spr = value;
+            break;
+        case SYSC:
+            if ((value & 0x02) != 0) model_reset();
+            break;
+        default:
+            m.regs[offset / 4] = value;
+            break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline bool status_register(uint32_t offset) {
+    return (offset == LSR) || (offset == SSR) || (offset == RXFIFO_LVL) ||
+           (offset == TXFIFO_LVL);
+}
+
+/**
+ * method to account an access to the test controller, a read of a status
+ * register repeating the previous access with the same result is a poll
+ */
+static void account(uint32_t offset, bool write, uint32_t value) {
+    bool poll = !write && last.read && (last.offset == offset) &&
+                (last.value == value) && status_register(offset);
+    if (poll)
+        polls++;
+    else
+        accesses++;
+    last.offset = offset;
+    last.value  = value;
+    last.read   = !write;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void segv_handler(int sig, siginfo_t* info, void* context) {
+    ucontext_t* uc   = context;
+    uintptr_t   addr = (uintptr_t)info->si_addr;
+    uintptr_t   page = addr & ~(uintptr_t)(PAGE_SIZE - 1);
+
+    pending.page  = 0;
+    for (unsigned i = 0; i < sizeof(uart_base) / sizeof(uart_base[0]); i++)
+        if (page == uart_base[i]) pending.page = (uint8_t*)page;
+    if (pending.page == 0) {
+        signal(sig, SIG_DFL);  // genuine fault
+        return;
+    }
+
+    pending.offset = (addr - page) & ~3u;
+    pending.write  = (uc->uc_mcontext.gregs[REG_ERR] & PF_WRITE) != 0;
+    pending.model  = page == uart_base[TEST_UART];
+
+    // expose the value to be read, let the instruction execute and
+    // catch it right after with the single step trap
+    mprotect(pending.page, PAGE_SIZE, PROT_READ | PROT_WRITE);
+    if (pending.model) {
+        model_tick();
+        uint32_t value = model_read(pending.offset, !pending.write);
+        memcpy(pending.page + pending.offset, &value, sizeof(value));
+        account(pending.offset, pending.write, value);
+    }
+    uc->uc_mcontext.gregs[REG_EFL] |= TRAP_FLAG;
+}
+
+static void trap_handler(int sig, siginfo_t* info, void* context) {
+    ucontext_t* uc = context;
+    (void)sig;
+    (void)info;
+
+    if (pending.model && pending.write) {
+        uint32_t value;
+        memcpy(&value, pending.page + pending.offset, sizeof(value));
+        model_write(pending.offset, value);
+    }
+    mprotect(pending.page, PAGE_SIZE, PROT_NONE);
+    uc->uc_mcontext.gregs[REG_EFL] &= ~TRAP_FLAG;
+}
+
+static int sim_init(void) {
+    for (unsigned i = 0; i < sizeof(uart_base) / sizeof(uart_base[0]); i++) {
+        void* p = mmap((void*)uart_base[i], PAGE_SIZE, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1,
+                       0);
+        if (p != (void*)uart_base[i]) return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags     = SA_SIGINFO;
+    sa.sa_sigaction = segv_handler;
+    sigaction(SIGSEGV, &sa, 0);
+    sa.sa_sigaction = trap_handler;
+    sigaction(SIGTRAP, &sa, 0);
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * stubs of the modules used by the uart driver
+ * -------------------------------------------------------------------------- */
+
+void am335x_clock_enable_uart_module(int module) { (void)module; }
+void am335x_mux_setup_uart_pins(int ctrl) { (void)ctrl; }
+void IntSystemEnable(unsigned int irq) { (void)irq, irq_enabled = true; }
+void IntSystemDisable(unsigned int irq) { (void)irq, irq_enabled = false; }
+unsigned int IntRawStatusGet(unsigned int irq) { return (void)irq, 0; }
+void am335x_edma_init(void) {}
+void am335x_edma_map_event(int ch, int ev) { (void)ch, (void)ev; }
+void am335x_edma_attach(int ch, void* r, void* p) { (void)ch, (void)r, (void)p; }
+void am335x_edma_setup(int ch, const void* x) { (void)ch, (void)x; }
+void am335x_edma_enable(int ch) { (void)ch; }
+void am335x_edma_disable(int ch) { (void)ch; }
+void am335x_edma_clear(int ch) { (void)ch; }
+void am335x_edma_mask_interrupt(int ch) { (void)ch; }
+void am335x_edma_unmask_interrupt(int ch) { (void)ch; }
+uint32_t am335x_edma_remaining(int ch) { return (void)ch, 0; }
+void arm_flush_cache(uint32_t* a, uint32_t l) { (void)a, (void)l; }
+void arm_dcache_invalidate(uint32_t* a, uint32_t l) { (void)a, (void)l; }
+
+/* -------------------------------------------------------------------------- */
+
+static uint8_t tx_buf[NB_BYTES];
+static uint8_t rx_buf[NB_BYTES];
+
+/**
+ * method to let the time go by while the cpu is busy elsewhere and to
+ * deliver the uart interrupt
+ */
+static void idle(void) {
+    model_tick();
+    if (irq_enabled && irq_pending()) am335x_uart_interrupt_handler(TEST_UART);
+}
+
+/**
+ * method to let the line run for a number of characters while the cpu is
+ * busy elsewhere, as a burst user does between two bursts
+ */
+static void busy_elsewhere(uint32_t nb_chars) {
+    for (uint64_t i = (uint64_t)nb_chars * m.char_time; i > 0; i--) idle();
+}
+
+static bool run(enum bench_modes mode, uint32_t char_time) {
+    am335x_uart_init(TEST_UART);
+    m.char_time = char_time;
+    am335x_uart_set_loopback(TEST_UART, true);
+    if (mode == INTERRUPT)
+        am335x_uart_set_mode(TEST_UART, AM335X_UART_INTERRUPT);
+    memset(rx_buf, 0, sizeof(rx_buf));
+    accesses = 0;
+    polls    = 0;
+    memset(&last, 0, sizeof(last));
+
+    // allow three times the theoretical transfer time
+    uint64_t deadline = m.now + (uint64_t)NB_BYTES * char_time * 3;
+    size_t   tx       = 0;
+    size_t   rx       = 0;
+    while ((rx < NB_BYTES) && (m.now < deadline)) {
+        if (mode == POLLED) {
+            if ((tx < NB_BYTES) && (tx - rx < FIFO_WINDOW))
+                am335x_uart_write(TEST_UART, tx_buf[tx++]);
+            if (am335x_uart_tstc(TEST_UART))
+                rx_buf[rx++] = am335x_uart_read(TEST_UART);
+        } else {
+            size_t window = mode == BURST ? FIFO_WINDOW : RING_WINDOW;
+            size_t room   = window - (tx - rx);
+            if (room > NB_BYTES - tx) room = NB_BYTES - tx;
+            if (room > 0)
+                tx += am335x_uart_write_buf(TEST_UART, &tx_buf[tx], room);
+            rx += am335x_uart_read_buf(TEST_UART, &rx_buf[rx], NB_BYTES - rx);
+            if (mode == BURST) busy_elsewhere(FIFO_WINDOW / 2);
+        }
+        idle();
+    }
+    am335x_uart_set_mode(TEST_UART, AM335X_UART_POLLING);
+    return memcmp(tx_buf, rx_buf, NB_BYTES) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    if (sim_init() != 0) {
+        perror("uart_sim: cannot map the uart register blocks");
+        return 1;
+    }
+    for (int i = 0; i < NB_BYTES; i++) tx_buf[i] = i * 7 + (i >> 8);
+
+    printf("uart register accesses, %d bytes in internal loopback\n",
+           NB_BYTES);
+    printf("%10s %-10s %12s %12s %s\n", "char time", "mode", "access/byte",
+           "polls/byte", "status");
+    bool passed = true;
+    for (unsigned t = 0; t < sizeof(char_times) / sizeof(char_times[0]); t++) {
+        uint64_t polled = 0;
+        for (int mode = 0; mode < NB_MODES; mode++) {
+            bool ok = run(mode, char_times[t]);
+
+            // burst and interrupt modes must cut the register accesses
+            if (mode == POLLED)
+                polled = accesses;
+            else if (accesses >= polled)
+                ok = false;
+            passed = passed && ok;
+
+            printf("%10u %-10s %12.2f %12.2f %s\n", char_times[t],
+                   mode_names[mode], (double)accesses / NB_BYTES,
+                   (double)polls / NB_BYTES, ok ? "ok" : "FAILED");
+        }
+    }
+    printf("%10s %-10s %12s %12s\n", "-", "dma", "n/a", "n/a");
+    return passed ? 0 : 1;
+}
@@ -11,10 +11,13 @@
 #include "am335x_clock.h"
 #include "am335x_console.h"
 #include "am335x_dmtimer1.h"
+#include "am335x_edma.h"
 #include "am335x_epwm.h"
 #include "am335x_gpio.h"
 #include "am335x_gpmc.h"
 #include "am335x_i2c.h"
+#include "am335x_i2c_eeprom.h"
+#include "am335x_i2c_regmap.h"
 #include "am335x_mux.h"
 #include "am335x_pru.h"
 #include "am335x_spi.h"
@@ -76,11 +76,24 @@ static inline void am335x_console_putc(char c) {
 
 /**
  * methods to send a character string on the serial interface.
+ * the line endings are expanded as by am335x_console_putc into a staging
+ * buffer, which is sent by bursts.
  *
  * @param s character string to send on the serial interface
  */
 static inline void am335x_console_puts(const char* s) {
-  while (*s) am335x_console_putc(*s++);
+  char buf[64];
+  size_t nb = 0;
+  while (*s) {
+    char c = *s++;
+    buf[nb++] = c;
+    if (c == '\n') buf[nb++] = '\r';
+    if (c == '\r') buf[nb++] = '\n';
+    if ((nb >= sizeof(buf) - 1) || (*s == 0)) {
+      am335x_uart_write_burst(AM335X_UART0, buf, nb);
+      nb = 0;
+    }
+  }
 }
 
 #endif
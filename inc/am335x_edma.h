@@ -0,0 +1,158 @@
+#pragma once
+#ifndef AM335X_EDMA_H
+#define AM335X_EDMA_H
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x EDMA3 Driver
+ *
+ * Purpose: This module implements basic services to drive the AM335x EDMA3
+ *          channel controller for event triggered peripheral transfers.
+ *          Channel n always uses PaRAM set n and completion code n, the
+ *          PaRAM sets 64 to 255 are free to be used as link sets.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * number of dma channels and PaRAM sets of the am335x EDMA3 controller
+ */
+#define AM335X_EDMA_NB_CHANNELS  64
+#define AM335X_EDMA_NB_PARAMSETS 256
+
+/**
+ * link value terminating a transfer
+ */
+#define AM335X_EDMA_NO_LINK      0xffff
+
+/**
+ * description of an A-synchronized transfer: each dma event moves acnt
+ * bytes, the transfer completes after bcnt events.
+ */
+struct am335x_edma_transfer {
+    const volatile void* src;       // source address
+    volatile void*       dst;       // destination address
+    uint16_t             acnt;      // number of bytes per event
+    uint16_t             bcnt;      // number of events
+    int16_t              src_bidx;  // source increment between two events
+    int16_t              dst_bidx;  // destination increment between two events
+    uint16_t             link;      // PaRAM set reloaded at completion
+    uint8_t              tcc;       // completion code (channel to notify)
+    bool                 interrupt; // raise completion interrupt
+};
+
+/**
+ * Prototype of the completion handler routine
+ *
+ * @param channel dma channel whose transfer completed
+ * @param param application specific parameter
+ */
+typedef void (*am335x_edma_handler_t)(uint32_t channel, void* param);
+
+/**
+ * method to initialize the EDMA3 controller,
+ * this method should be called prior any other method.
+ */
+extern void am335x_edma_init(void);
+
+/**
+ * method to route a crossbar event onto a dma channel
+ *
+ * @param channel dma channel number
+ * @param xbar_event crossbar event number (0 restores the direct event)
+ */
+extern void am335x_edma_map_event(uint32_t channel, uint32_t xbar_event);
+
+/**
+ * method to attach a completion handler to a dma channel
+ *
+ * @param channel dma channel number
+ * @param routine completion handler (0 to detach)
+ * @param param application specific parameter
+ */
+extern void am335x_edma_attach(uint32_t channel,
+                               am335x_edma_handler_t routine,
+                               void* param);
+
+/**
+ * method to program a PaRAM set
+ *
+ * @param entry PaRAM set number (channel number or link set)
+ * @param xfer transfer description
+ */
+extern void am335x_edma_setup(uint32_t entry,
+                              const struct am335x_edma_transfer* xfer);
+
+/**
+ * method to get the number of events still expected by a PaRAM set
+ *
+ * @param entry PaRAM set number
+ * @return remaining number of events (bcnt)
+ */
+extern uint32_t am335x_edma_remaining(uint32_t entry);
+
+/**
+ * method to enable the hardware event of a dma channel
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_enable(uint32_t channel);
+
+/**
+ * method to disable the hardware event of a dma channel,
+ * an already latched event stays pending.
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_disable(uint32_t channel);
+
+/**
+ * method to clear pending and missed events of a dma channel
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_clear(uint32_t channel);
+
+/**
+ * method to mask the completion interrupt of a dma channel,
+ * completions are kept pending until the interrupt is unmasked.
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_mask_interrupt(uint32_t channel);
+
+/**
+ * method to unmask the completion interrupt of a dma channel
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_unmask_interrupt(uint32_t channel);
+
+/**
+ * method to trigger a dma channel by software
+ *
+ * @param channel dma channel number
+ */
+extern void am335x_edma_trigger(uint32_t channel);
+
+/**
+ * interrupt service routine. Should be attached to INTC (SYS_INT_EDMACOMPINT)
+ */
+extern void am335x_edma_interrupt_handler(void);
+
+#endif
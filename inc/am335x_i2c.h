@@ -39,6 +39,73 @@ enum am335x_i2c_controllers {
     AM335X_I2C2,
 };
 
+/**
+ * error codes returned by the i2c methods, 0 meaning success. all waits are
+ * bounded by deadlines derived from the bus speed; a transfer stuck beyond
+ * its deadline is aborted and the bus is recovered by clocking out the
+ * pending bits of the slave followed by a stop condition.
+ */
+enum am335x_i2c_errors {
+    AM335X_I2C_ENACK     = -1,  // not acknowledged by the chip
+    AM335X_I2C_EARB      = -2,  // arbitration lost
+    AM335X_I2C_EACCESS   = -3,  // access error on the controller fifos
+    AM335X_I2C_ETIMEOUT  = -4,  // transfer stuck, the bus has been recovered
+    AM335X_I2C_EBUSY     = -5,  // bus still busy after a recovery
+    AM335X_I2C_EINVAL    = -6,  // invalid parameters
+    AM335X_I2C_ECANCELED = -7,  // not executed, a former message failed
+};
+
+/**
+ * chips present on an i2c bus, the chip with address n is present if bit
+ * (n % 32) of map[n / 32] is set
+ */
+struct am335x_i2c_devices {
+    uint32_t map[128 / 32];
+};
+
+/**
+ * message of a combined transfer, see am335x_i2c_transfer
+ */
+struct am335x_i2c_msg {
+    uint8_t  chip_id;  // chip identification, its address
+    bool     read;     // true=read data, false=write data
+    uint8_t* buf;      // data buffer
+    uint16_t len;      // number of data bytes (at least 1)
+    int      status;   // 0=success, error code otherwise
+};
+
+struct am335x_i2c_request;
+
+/**
+ * Prototype of the transaction completion handler, called in interrupt context
+ *
+ *@param ctrl am335x i2c controller name
+ *@param req completed request, its status field holds the result
+ *@param param application specific parameter
+ */
+typedef void (*am335x_i2c_handler_t)(enum am335x_i2c_controllers ctrl,
+                                     struct am335x_i2c_request* req,
+                                     void* param);
+
+/**
+ * asynchronous transaction request, owned by the driver until its done flag
+ * is set
+ */
+struct am335x_i2c_request {
+    uint8_t                    chip_id;   // chip identification, its address
+    uint32_t                   reg;       // internal chip register address
+    uint8_t                    reg_size;  // register address size (0 to 3)
+    bool                       read;      // true=read data, false=write data
+    uint8_t*                   data;      // data buffer
+    uint16_t                   data_len;  // number of data bytes
+    bool                       dma;       // move the data by dma
+    am335x_i2c_handler_t       routine;   // completion handler (optional)
+    void*                      param;     // application specific parameter
+    volatile bool              done;      // set when the request has completed
+    int                        status;    // 0=success, error code otherwise
+    struct am335x_i2c_request* next;      // reserved for the driver
+};
+
 /**
  * method to initialize a specific am335x i2c controller,
  * this method should be called prior any other method.
@@ -49,17 +116,41 @@ enum am335x_i2c_controllers {
 extern void am335x_i2c_init(enum am335x_i2c_controllers ctrl,
                             uint32_t bus_speed);
 
+/**
+ * method to change the bus speed. the prescaler and the scl low and high
+ * times are computed for the standard (100 kHz), fast (400 kHz), fast plus
+ * (1 MHz) and high speed (3.4 MHz) modes; the highest speed not above the
+ * requested one is selected. in high speed mode each transfer starts with
+ * the master code sent in fast mode.
+ *
+ *@param ctrl am335x i2c controller name
+ *@param bus_speed i2c bus speed in Hz
+ *
+ *@return int status, 0=success, -1=speed not supported
+ */
+extern int am335x_i2c_set_bus_speed(enum am335x_i2c_controllers ctrl,
+                                    uint32_t bus_speed);
+
+/**
+ * method to get the bus speed effectively generated by the controller
+ *
+ *@param ctrl am335x i2c controller name
+ *
+ *@return achieved scl frequency in Hz
+ */
+extern uint32_t am335x_i2c_get_bus_speed(enum am335x_i2c_controllers ctrl);
+
 /**
  * method to read data bytes from the internal register files of
  * the specified chip.
  *
  *@param chip_id chip identification, its address
  *@param reg internal chip register address from which the data byte should be
- *read
+ *read, the read follows with a repeated start condition
  *@param data data buffer containing the read data bytes
  *@param data_len number of data byte to read
  *
- *@return int status, 0=success, -1=error
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
  */
 extern int am335x_i2c_read(enum am335x_i2c_controllers ctrl,
                            uint8_t chip_id,
@@ -77,7 +168,7 @@ extern int am335x_i2c_read(enum am335x_i2c_controllers ctrl,
  *@param buffer data buffer containing the data bytes to write
  *@param buffer_len number of data byte to write
  *
- *@return int status, 0=success, -1=error
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
  */
 extern int am335x_i2c_write(enum am335x_i2c_controllers ctrl,
                             uint8_t chip_id,
@@ -85,6 +176,61 @@ extern int am335x_i2c_write(enum am335x_i2c_controllers ctrl,
                             const uint8_t* data,
                             uint16_t data_len);
 
+/**
+ * method to read data bytes from the internal register files of the
+ * specified chip with a register address of 0 to 3 bytes (msb first).
+ * the address and the data are combined with a repeated start condition.
+ *
+ *@param chip_id chip identification, its address
+ *@param reg internal chip register address
+ *@param reg_size size of the register address in bytes (0 to 3)
+ *@param data data buffer containing the read data bytes
+ *@param data_len number of data byte to read
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_read_ext(enum am335x_i2c_controllers ctrl,
+                               uint8_t chip_id,
+                               uint32_t reg,
+                               uint32_t reg_size,
+                               uint8_t* data,
+                               uint16_t data_len);
+
+/**
+ * method to write data bytes into the internal register files of the
+ * specified chip with a register address of 0 to 3 bytes (msb first).
+ *
+ *@param chip_id chip identification, its address
+ *@param reg internal chip register address
+ *@param reg_size size of the register address in bytes (0 to 3)
+ *@param data data buffer containing the data bytes to write
+ *@param data_len number of data byte to write
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_write_ext(enum am335x_i2c_controllers ctrl,
+                                uint8_t chip_id,
+                                uint32_t reg,
+                                uint32_t reg_size,
+                                const uint8_t* data,
+                                uint16_t data_len);
+
+/**
+ * method to execute a list of read and write messages back to back, the
+ * messages are separated by repeated start conditions and the bus is
+ * released with a stop condition after the last one. the transfer is
+ * aborted at the first message in error.
+ *
+ *@param ctrl am335x i2c controller name
+ *@param msgs list of messages, their status field is updated
+ *@param n number of messages
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_transfer(enum am335x_i2c_controllers ctrl,
+                               struct am335x_i2c_msg* msgs,
+                               uint32_t n);
+
 /**
  * method to see if a chip is present on the I2C bus.
  *
@@ -94,4 +240,73 @@ extern int am335x_i2c_write(enum am335x_i2c_controllers ctrl,
  */
 extern bool am335x_i2c_probe(enum am335x_i2c_controllers ctrl, uint8_t chip_id);
 
+/**
+ * method to enumerate the chips present on several i2c buses. the buses
+ * are scanned concurrently by interrupt, each address from 0x08 to 0x77
+ * being probed with a one byte read; a probe not completed within twice
+ * its nominal duration is aborted and the bus recovered. the result is
+ * kept by the driver and later calls to am335x_i2c_probe for the scanned
+ * addresses are answered without any bus access.
+ * am335x_i2c_interrupt_handler must have been attached to the interrupt
+ * vector of each controller and no other request should be pending.
+ *
+ *@param ctrls list of am335x i2c controllers to scan
+ *@param nb number of controllers
+ *@param devices chips found on each bus, in the order of ctrls (optional)
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_scan(const enum am335x_i2c_controllers* ctrls,
+                           uint32_t nb,
+                           struct am335x_i2c_devices* devices);
+
+/**
+ * method to forget the result of the last scan of a bus, e.g. after a
+ * chip has been plugged or powered, the probes access the bus again
+ *
+ *@param ctrl am335x i2c controller name
+ */
+extern void am335x_i2c_scan_invalidate(enum am335x_i2c_controllers ctrl);
+
+/**
+ * method to check if a chip is present in a scan result
+ *
+ *@param devices chips found on a bus
+ *@param chip_id chip identification, its address
+ *
+ *@return bool true if the chip is present, false otherwise
+ */
+static inline bool am335x_i2c_device_present(
+    const struct am335x_i2c_devices* devices, uint8_t chip_id) {
+    return (devices->map[(chip_id / 32) & 3] & (1u << (chip_id % 32))) != 0;
+}
+
+/**
+ * method to submit an asynchronous transaction. the request is queued and
+ * processed by the i2c interrupt once all previously submitted requests have
+ * completed; the method returns immediately. completion is signaled by the
+ * done flag of the request and by its completion handler.
+ * am335x_i2c_interrupt_handler must have been attached to the controller
+ * interrupt vector and the polled methods must not be used while requests
+ * are pending on the same controller.
+ * requests with the dma flag move their data without any cpu intervention,
+ * am335x_edma_interrupt_handler must then be attached as well and the data
+ * buffer of a read should be aligned on cache lines.
+ *
+ *@param ctrl am335x i2c controller name
+ *@param req transaction request
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_submit(enum am335x_i2c_controllers ctrl,
+                             struct am335x_i2c_request* req);
+
+/**
+ * interrupt handler driving the asynchronous transactions, to be attached
+ * to the interrupt vector of the i2c controller
+ *
+ *@param ctrl am335x i2c controller name
+ */
+extern void am335x_i2c_interrupt_handler(enum am335x_i2c_controllers ctrl);
+
 #endif
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef AM335X_I2C_EEPROM_H
+#define AM335X_I2C_EEPROM_H
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x I2C EEPROM access (24xx family)
+ *
+ * Purpose: This module implements reads and writes of any length into an
+ *          i2c eeprom, layered over the am335x i2c driver. Writes are split
+ *          on page boundaries and the end of each internal write cycle is
+ *          detected by acknowledge polling, so that the next page is
+ *          written as soon as the device is ready. Reads are sequential.
+ *          Address bits above the memory address bytes are carried by the
+ *          chip address (block select of the small and large devices).
+ */
+
+#include <stdint.h>
+
+#include "am335x_i2c.h"
+
+/**
+ * maximum duration of an internal write cycle (tWR) of most 24xx devices
+ */
+#define AM335X_I2C_EEPROM_WRITE_TIME_US 5000
+
+/**
+ * eeprom description, to be initialized with am335x_i2c_eeprom_init
+ */
+struct am335x_i2c_eeprom {
+    enum am335x_i2c_controllers ctrl;        // i2c controller of the device
+    uint8_t                     chip_id;     // chip identification
+    uint32_t                    addr_size;   // memory address size (1 or 2)
+    uint32_t                    page_size;   // write page size in bytes
+    uint32_t                    size;        // memory size in bytes
+    uint32_t                    write_time;  // max write cycle time in us
+};
+
+/**
+ * method to initialize the description of an eeprom
+ *
+ *@param eeprom eeprom description
+ *@param ctrl am335x i2c controller name
+ *@param chip_id chip identification, address of the first block
+ *@param addr_size size of the memory address in bytes (1 or 2)
+ *@param page_size write page size in bytes (power of 2)
+ *@param size memory size in bytes
+ *@param write_time maximum write cycle time in us, bound of the polling
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_eeprom_init(struct am335x_i2c_eeprom* eeprom,
+                                  enum am335x_i2c_controllers ctrl,
+                                  uint8_t chip_id,
+                                  uint32_t addr_size,
+                                  uint32_t page_size,
+                                  uint32_t size,
+                                  uint32_t write_time);
+
+/**
+ * method to read data from an eeprom with sequential reads
+ *
+ *@param eeprom eeprom description
+ *@param addr memory address of the first byte
+ *@param data buffer receiving the read data
+ *@param len number of bytes to read
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_eeprom_read(const struct am335x_i2c_eeprom* eeprom,
+                                  uint32_t addr,
+                                  void* data,
+                                  uint32_t len);
+
+/**
+ * method to write data into an eeprom, one page at a time. the method
+ * returns once the last write cycle has completed.
+ *
+ *@param eeprom eeprom description
+ *@param addr memory address of the first byte
+ *@param data data to write
+ *@param len number of bytes to write
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_eeprom_write(const struct am335x_i2c_eeprom* eeprom,
+                                   uint32_t addr,
+                                   const void* data,
+                                   uint32_t len);
+
+#endif
@@ -0,0 +1,155 @@
+#pragma once
+#ifndef AM335X_I2C_REGMAP_H
+#define AM335X_I2C_REGMAP_H
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x I2C device register map cache
+ *
+ * Purpose: This module implements a shadow copy of the 8-bit registers of
+ *          an i2c device, layered over the am335x i2c driver. Cached
+ *          registers are read from the bus only once; writes are either
+ *          forwarded immediately (write-through) or kept dirty until the
+ *          next sync, which writes consecutive dirty registers in a single
+ *          burst (write-back). Registers changed by the device itself
+ *          (status, data, fifo...) must be declared volatile, they are
+ *          always accessed on the bus.
+ *          The device must auto-increment its register address.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "am335x_i2c.h"
+
+/**
+ * maximum number of registers held by a register map
+ */
+#define AM335X_I2C_REGMAP_SIZE 256
+
+/**
+ * register map of an i2c device, to be initialized with
+ * am335x_i2c_regmap_init
+ */
+struct am335x_i2c_regmap {
+    enum am335x_i2c_controllers ctrl;        // i2c controller of the device
+    uint8_t                     chip_id;     // chip identification
+    uint32_t                    reg_size;    // register address size (1 to 3)
+    uint32_t                    base;        // first cached register
+    uint32_t                    nb_regs;     // number of cached registers
+    bool                        write_back;  // writes kept until sync
+    uint32_t volatile_regs[AM335X_I2C_REGMAP_SIZE / 32];  // never cached
+    uint32_t valid[AM335X_I2C_REGMAP_SIZE / 32];  // cache holds the value
+    uint32_t dirty[AM335X_I2C_REGMAP_SIZE / 32];  // value not yet written
+    uint8_t  values[AM335X_I2C_REGMAP_SIZE];
+};
+
+/**
+ * method to initialize a register map, all registers are initially unknown.
+ * registers outside [base, base + nb_regs[ are accessed without caching.
+ *
+ *@param map register map
+ *@param ctrl am335x i2c controller name
+ *@param chip_id chip identification, its address
+ *@param reg_size size of the register address in bytes (1 to 3)
+ *@param base first cached register
+ *@param nb_regs number of cached registers (max AM335X_I2C_REGMAP_SIZE)
+ *@param write_back true to keep the writes until the next sync,
+ *                  false to write them through
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_regmap_init(struct am335x_i2c_regmap* map,
+                                  enum am335x_i2c_controllers ctrl,
+                                  uint8_t chip_id,
+                                  uint32_t reg_size,
+                                  uint32_t base,
+                                  uint32_t nb_regs,
+                                  bool write_back);
+
+/**
+ * method to declare a range of registers as volatile
+ *
+ *@param map register map
+ *@param reg first volatile register
+ *@param nb number of volatile registers
+ */
+extern void am335x_i2c_regmap_set_volatile(struct am335x_i2c_regmap* map,
+                                           uint32_t reg,
+                                           uint32_t nb);
+
+/**
+ * method to read a register, from the cache if its value is known
+ *
+ *@param map register map
+ *@param reg register address
+ *@param value read value
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_regmap_read(struct am335x_i2c_regmap* map,
+                                  uint32_t reg,
+                                  uint8_t* value);
+
+/**
+ * method to write a register. in write-through mode the bus is only
+ * accessed if the value differs from the cached one.
+ *
+ *@param map register map
+ *@param reg register address
+ *@param value value to write
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_regmap_write(struct am335x_i2c_regmap* map,
+                                   uint32_t reg,
+                                   uint8_t value);
+
+/**
+ * method to modify some bits of a register (read-modify-write)
+ *
+ *@param map register map
+ *@param reg register address
+ *@param mask bits to modify
+ *@param value new value of the bits to modify
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_regmap_update_bits(struct am335x_i2c_regmap* map,
+                                         uint32_t reg,
+                                         uint8_t mask,
+                                         uint8_t value);
+
+/**
+ * method to write all dirty registers to the device, consecutive dirty
+ * registers are written in a single burst
+ *
+ *@param map register map
+ *
+ *@return int status, 0=success, error code otherwise (am335x_i2c_errors)
+ */
+extern int am335x_i2c_regmap_sync(struct am335x_i2c_regmap* map);
+
+/**
+ * method to forget the cached values, e.g. after a reset of the device.
+ * dirty registers are discarded.
+ *
+ *@param map register map
+ */
+extern void am335x_i2c_regmap_invalidate(struct am335x_i2c_regmap* map);
+
+#endif
@@ -105,6 +105,15 @@ enum am335x_mux_gpio_pin_pull {
  */
 extern void am335x_mux_setup_uart_pins(enum am335x_mux_uart_modules module);
 
+/**
+ * method to setup uart hardware flow control pins (ctsn/rtsn) for use.
+ * only available for UART0, UART1, UART4 and UART5.
+ *
+ * @param   module uart controller name (instance number)
+ * @return  execution status (0=success, -1=pins not available)
+ */
+extern int am335x_mux_setup_uart_flow_pins(enum am335x_mux_uart_modules module);
+
 /**
  * method to setup i2c pins for use.
  *
@@ -27,6 +27,7 @@
  * Date:    24.08.2015
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -46,6 +47,35 @@ enum am335x_spi_channels {
     AM335X_CHAN1,
 };
 
+struct am335x_spi_dma_request;
+
+/**
+ * Prototype of the dma transfer completion handler, called in interrupt
+ * context
+ *
+ *@param ctrl am335x spi controller name
+ *@param req completed request
+ *@param param application specific parameter
+ */
+typedef void (*am335x_spi_dma_handler_t)(enum am335x_spi_controllers ctrl,
+                                         struct am335x_spi_dma_request* req,
+                                         void* param);
+
+/**
+ * dma transfer request, owned by the driver until its done flag is set
+ */
+struct am335x_spi_dma_request {
+    enum am335x_spi_channels       channel;  // channel (chip select) to use
+    const uint8_t*                 tx;       // data to send (0: send zeros)
+    uint8_t*                       rx;       // received data (0: discarded)
+    size_t                         len;      // bytes, whole words (max 65535)
+    bool                           hold;     // keep chip select active after
+    am335x_spi_dma_handler_t       routine;  // completion handler (optional)
+    void*                          param;    // application specific parameter
+    volatile bool                  done;     // set when the request completed
+    struct am335x_spi_dma_request* next;     // reserved for the driver
+};
+
 /**
  * method to initialize a specific am335x spi controller,
  * this method should be called prior any other method.
@@ -63,6 +93,8 @@ extern void am335x_spi_init(
 
 /**
  * method to transfer data bytes to and from the specified chip.
+ * the bytes are streamed back to back through the 64 bytes fifo, four of
+ * them per register access. the channel word length must not exceed 8 bits.
  *
  *@param ctrl am335x spi controller name
  *@param channel channel to be activated during transfer
@@ -78,4 +110,77 @@ extern int am335x_spi_xfer(
         uint8_t* buffer,
         size_t buffer_len);
 
+/**
+ * method to transfer data bytes with distinct transmit and receive
+ * buffers, which may be the same. without rx buffer the channel runs in
+ * transmit only mode and the received bytes are ignored; without tx buffer
+ * it runs in receive only mode, the chip receiving undefined bytes.
+ *
+ *@param ctrl am335x spi controller name
+ *@param channel channel to be activated during transfer
+ *@param tx data to send (0 for receive only)
+ *@param rx buffer receiving the data (0 for transmit only)
+ *@param len number of data bytes to transfer
+ *
+ *@return int status, 0=success, -1=error
+ */
+extern int am335x_spi_xfer_ext(enum am335x_spi_controllers ctrl,
+                               enum am335x_spi_channels channel,
+                               const uint8_t* tx,
+                               uint8_t* rx,
+                               size_t len);
+
+/**
+ * method to transfer words of 9 to 16 bits, see am335x_spi_xfer_ext.
+ * two words are moved per register access.
+ *
+ *@param ctrl am335x spi controller name
+ *@param channel channel to be activated during transfer
+ *@param tx words to send (0 for receive only)
+ *@param rx buffer receiving the words (0 for transmit only)
+ *@param len number of words to transfer
+ *
+ *@return int status, 0=success, -1=error (word length not 9 to 16 bits)
+ */
+extern int am335x_spi_xfer16(enum am335x_spi_controllers ctrl,
+                             enum am335x_spi_channels channel,
+                             const uint16_t* tx,
+                             uint16_t* rx,
+                             size_t len);
+
+/**
+ * method to transfer words of 17 to 32 bits, see am335x_spi_xfer_ext
+ *
+ *@param ctrl am335x spi controller name
+ *@param channel channel to be activated during transfer
+ *@param tx words to send (0 for receive only)
+ *@param rx buffer receiving the words (0 for transmit only)
+ *@param len number of words to transfer
+ *
+ *@return int status, 0=success, -1=error (word length not 17 to 32 bits)
+ */
+extern int am335x_spi_xfer32(enum am335x_spi_controllers ctrl,
+                             enum am335x_spi_channels channel,
+                             const uint32_t* tx,
+                             uint32_t* rx,
+                             size_t len);
+
+/**
+ * method to queue a transfer executed by dma, the method returns
+ * immediately. the requests are executed in order, each one starting as
+ * soon as the previous one completes; a request with the hold flag keeps
+ * the chip select active so that the next one continues the same frame.
+ * completion is signaled by the done flag of the request and by its
+ * completion handler. am335x_edma_interrupt_handler must be attached to
+ * SYS_INT_EDMACOMPINT, the rx buffer should be aligned on cache lines and
+ * am335x_spi_xfer must not be used while requests are pending.
+ *
+ *@param ctrl am335x spi controller name
+ *@param req transfer request
+ *
+ *@return int status, 0=success, -1=error
+ */
+extern int am335x_spi_dma_xfer(enum am335x_spi_controllers ctrl,
+                               struct am335x_spi_dma_request* req);
+
 #endif
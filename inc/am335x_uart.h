@@ -29,6 +29,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // TODO make big endian when used
@@ -45,6 +46,63 @@ enum am335x_uart_controllers {
     AM335X_UART5,
 };
 
+/**
+ * defines the operating modes of an uart controller
+ */
+enum am335x_uart_modes {
+    AM335X_UART_POLLING,    // fifos accessed directly by the caller (default)
+    AM335X_UART_INTERRUPT,  // fifos served by the interrupt handler
+    AM335X_UART_DMA,        // fifos served by the EDMA3 controller
+};
+
+/**
+ * line error and data loss counters of a uart controller
+ */
+struct am335x_uart_stats {
+    uint32_t overrun;  // rx fifo overruns
+    uint32_t framing;  // framing errors
+    uint32_t parity;   // parity errors
+    uint32_t breaks;   // break conditions
+    uint32_t dropped;  // characters lost because the rx ring was full
+};
+
+/**
+ * Prototype of the rx burst handler routine, called in interrupt context
+ * once a burst has been moved into the rx ring
+ *
+ * @param ctrl am335x uart controller number
+ * @param available number of characters available in the rx ring
+ * @param param application specific parameter
+ */
+typedef void (*am335x_uart_rx_handler_t)(enum am335x_uart_controllers ctrl,
+                                         size_t available,
+                                         void* param);
+
+/**
+ * Prototype of the dma completion handler routine, called in interrupt context
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf buffer which has been sent or filled
+ * @param len number of bytes transferred
+ * @param param application specific parameter
+ */
+typedef void (*am335x_uart_dma_handler_t)(enum am335x_uart_controllers ctrl,
+                                          void* buf,
+                                          size_t len,
+                                          void* param);
+
+/**
+ * dma transmit request, owned by the driver until its completion handler
+ * has been called
+ */
+struct am335x_uart_dma_request {
+    const void*                     buf;      // data to send
+    size_t                          len;      // number of bytes (max 65535)
+    am335x_uart_dma_handler_t       routine;  // completion handler (optional)
+    void*                           param;    // application specific parameter
+    struct am335x_uart_dma_request* next;     // reserved for the driver
+};
+
 /**
  * method to initialize a specific am335x controller to work as a serial line.
  * by default the line will be configured as follow:
@@ -59,13 +117,26 @@ enum am335x_uart_controllers {
 extern void am335x_uart_init(enum am335x_uart_controllers ctrl);
 
 /**
- * method to change the baudrate
+ * method to change the baudrate. The oversampling mode (16x or 13x) and the
+ * divisor giving the lowest error are selected, rates from 183 bit/s (14-bit
+ * divisor) up to 3.6864 Mbit/s can be reached with the 48 MHz module clock.
  *
  * @param ctrl am335x uart controller number
  * @param baudrate terminal baudrate value in bit/s
+ * @return execution status (0=success, -1=rate not reachable within 2.5%)
  */
-extern void am335x_uart_set_baudrate(enum am335x_uart_controllers ctrl,
-                                     uint32_t baudrate);
+extern int am335x_uart_set_baudrate(enum am335x_uart_controllers ctrl,
+                                    uint32_t baudrate);
+
+/**
+ * method to get the baudrate effectively generated by the controller
+ *
+ * @param ctrl am335x uart controller number
+ * @param error_ppm deviation from the requested rate in ppm (may be 0)
+ * @return achieved baudrate value in bit/s
+ */
+extern uint32_t am335x_uart_get_baudrate(enum am335x_uart_controllers ctrl,
+                                         int32_t* error_ppm);
 
 /**
  * method to test if a character is available
@@ -93,4 +164,182 @@ extern int am335x_uart_read(enum am335x_uart_controllers ctrl);
  */
 extern void am335x_uart_write(enum am335x_uart_controllers ctrl, int c);
 
+/**
+ * method to select the operating mode of the controller.
+ * in interrupt mode the transmitted and received characters are buffered
+ * into rings served by am335x_uart_interrupt_handler, which must then be
+ * attached to the corresponding INTC interrupt line (SYS_INT_UARTxINT);
+ * the line itself is enabled and masked by the driver. in dma mode the
+ * am335x_edma_interrupt_handler must be attached to SYS_INT_EDMACOMPINT.
+ * leaving the dma mode cancels the pending transmit requests: their
+ * completion handlers are called from this method with the number of
+ * bytes actually sent.
+ * all six controllers can run concurrently in any mode.
+ *
+ * @param ctrl am335x uart controller number
+ * @param mode operating mode
+ */
+extern void am335x_uart_set_mode(enum am335x_uart_controllers ctrl,
+                                 enum am335x_uart_modes mode);
+
+/**
+ * method to send a buffer on the serial interface without blocking.
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf data to send on the serial interface
+ * @param len number of bytes to send
+ * @return number of bytes accepted for transmission
+ */
+extern size_t am335x_uart_write_buf(enum am335x_uart_controllers ctrl,
+                                    const void* buf,
+                                    size_t len);
+
+/**
+ * method to read the received characters without blocking.
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf buffer to store the received characters
+ * @param len size of the buffer in bytes
+ * @return number of bytes read
+ */
+extern size_t am335x_uart_read_buf(enum am335x_uart_controllers ctrl,
+                                   void* buf,
+                                   size_t len);
+
+/**
+ * method to configure the burst reception in interrupt mode.
+ * a burst is delivered to the handler either when the rx fifo reaches the
+ * threshold or, if idle is set, when the line stays idle for 4 character
+ * times while the fifo holds fewer characters (hardware rx timeout).
+ * a low threshold gives low latency, a high one less interrupts.
+ *
+ * @param ctrl am335x uart controller number
+ * @param threshold rx fifo trigger level in characters (1..63, default 60)
+ * @param idle true to deliver the burst on rx timeout as well
+ * @param routine burst handler (0 to disable the notification)
+ * @param param application specific parameter
+ * @return execution status (0=success, -1=invalid threshold)
+ */
+extern int am335x_uart_set_rx_burst(enum am335x_uart_controllers ctrl,
+                                    uint32_t threshold,
+                                    bool idle,
+                                    am335x_uart_rx_handler_t routine,
+                                    void* param);
+
+/**
+ * method to enable or disable the RTS/CTS hardware flow control.
+ * RTS is deasserted once the rx fifo holds halt characters and asserted
+ * again when it drops to restore characters; the transmitter is paused
+ * while CTS is deasserted. Levels are multiples of 4 (rounded down).
+ * The pins must be configured with am335x_mux_setup_uart_flow_pins.
+ *
+ * @param ctrl am335x uart controller number
+ * @param enable true to enable the auto RTS/CTS flow control
+ * @param halt rx fifo level deasserting RTS (4..60)
+ * @param restore rx fifo level asserting RTS again (0..halt-4)
+ * @return execution status (0=success, -1=invalid levels)
+ */
+extern int am335x_uart_set_flow_control(enum am335x_uart_controllers ctrl,
+                                        bool enable,
+                                        uint32_t halt,
+                                        uint32_t restore);
+
+/**
+ * method to enable or disable the internal loopback, the transmitted
+ * characters are then received back by the controller itself
+ *
+ * @param ctrl am335x uart controller number
+ * @param enable true to enable the loopback
+ */
+extern void am335x_uart_set_loopback(enum am335x_uart_controllers ctrl,
+                                     bool enable);
+
+/**
+ * method to get the line error and data loss counters
+ *
+ * @param ctrl am335x uart controller number
+ * @param stats structure to store the counters
+ */
+extern void am335x_uart_get_stats(enum am335x_uart_controllers ctrl,
+                                  struct am335x_uart_stats* stats);
+
+/**
+ * method to reset the line error and data loss counters
+ *
+ * @param ctrl am335x uart controller number
+ */
+extern void am335x_uart_reset_stats(enum am335x_uart_controllers ctrl);
+
+/**
+ * method to send a buffer by bursts: the fifo level is read once and as
+ * many characters as the fifo can hold are then written back-to-back.
+ * the caller will be suspended until all characters have been queued.
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf characters to send
+ * @param len number of characters to send
+ */
+extern void am335x_uart_write_burst(enum am335x_uart_controllers ctrl,
+                                    const void* buf,
+                                    size_t len);
+
+/**
+ * method to receive a buffer by bursts: the fifo level is read once and as
+ * many characters as available are then read back-to-back.
+ * the caller will be suspended until all characters have been received.
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf buffer to store the received characters
+ * @param len number of characters to receive
+ */
+extern void am335x_uart_read_burst(enum am335x_uart_controllers ctrl,
+                                   void* buf,
+                                   size_t len);
+
+/**
+ * method to queue a buffer for transmission in dma mode.
+ * the buffer is sent once all previously queued requests have completed.
+ *
+ * @param ctrl am335x uart controller number
+ * @param req transmit request
+ * @return execution status (0=success, -1=error)
+ */
+extern int am335x_uart_dma_write(enum am335x_uart_controllers ctrl,
+                                 struct am335x_uart_dma_request* req);
+
+/**
+ * method to start continuous reception in dma mode.
+ * the two buffers are filled alternately, the completion handler is called
+ * each time a buffer is full and must release it before the other one is.
+ *
+ * @param ctrl am335x uart controller number
+ * @param buf0 first reception buffer
+ * @param buf1 second reception buffer
+ * @param len size of each buffer in bytes (max 65535)
+ * @param routine completion handler
+ * @param param application specific parameter
+ * @return execution status (0=success, -1=error)
+ */
+extern int am335x_uart_dma_start_read(enum am335x_uart_controllers ctrl,
+                                      void* buf0,
+                                      void* buf1,
+                                      size_t len,
+                                      am335x_uart_dma_handler_t routine,
+                                      void* param);
+
+/**
+ * method to stop the dma reception
+ *
+ * @param ctrl am335x uart controller number
+ */
+extern void am335x_uart_dma_stop_read(enum am335x_uart_controllers ctrl);
+
+/**
+ * interrupt service routine. Should be attached to INTC for processing
+ * when the controller runs in interrupt mode.
+ *
+ * @param ctrl am335x uart controller number
+ */
+extern void am335x_uart_interrupt_handler(enum am335x_uart_controllers ctrl);
+
 #endif
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef DLOG_H
+#define DLOG_H
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Deferred binary logging
+ *
+ * Purpose: This module implements a deferred log facility. A log call only
+ *          stores the address of its format string, a DMTimer1 timestamp
+ *          and its raw arguments into a RAM ring; the formatting is done
+ *          on the host by tools/dlog_decode.py from the ELF file.
+ *          The format strings are placed in the .dlog_fmt section.
+ *          Arguments are stored as 32-bit words: integers, characters and
+ *          pointers are supported, %s is resolved on the host and thus
+ *          only valid for strings of the application image.
+ *
+ *          Frame format (words in target byte order):
+ *            0xa5 | nargs (8) | format address (32) | timestamp (32) |
+ *            nargs * argument (32)
+ *          A frame with the format address 0 reports the number of frames
+ *          lost because the ring was full.
+ */
+
+#include <stdint.h>
+
+/**
+ * method to log a message, callable from thread and interrupt context.
+ * at most 8 arguments are supported.
+ *
+ * @param fmt printf like format string (must be a string literal)
+ */
+#define DLOG(fmt, ...)                                                  \
+    do {                                                                \
+        static const char dlog_fmt[]                                    \
+            __attribute__((section(".dlog_fmt"), used)) = fmt;          \
+        const uint32_t dlog_args[] = {0, DLOG_MAP(__VA_ARGS__)};        \
+        dlog_record(dlog_fmt, dlog_args + 1, DLOG_NARGS(__VA_ARGS__));  \
+    } while (0)
+
+// helper macros to count and convert the arguments
+#define DLOG_NARGS(...) DLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define DLOG_CAT(a, b) DLOG_CAT_(a, b)
+#define DLOG_CAT_(a, b) a##b
+#define DLOG_MAP(...) DLOG_CAT(DLOG_MAP_, DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define DLOG_WORD(x) (uint32_t)(uintptr_t)(x)
+#define DLOG_MAP_0()
+#define DLOG_MAP_1(a) DLOG_WORD(a)
+#define DLOG_MAP_2(a, ...) DLOG_WORD(a), DLOG_MAP_1(__VA_ARGS__)
+#define DLOG_MAP_3(a, ...) DLOG_WORD(a), DLOG_MAP_2(__VA_ARGS__)
+#define DLOG_MAP_4(a, ...) DLOG_WORD(a), DLOG_MAP_3(__VA_ARGS__)
+#define DLOG_MAP_5(a, ...) DLOG_WORD(a), DLOG_MAP_4(__VA_ARGS__)
+#define DLOG_MAP_6(a, ...) DLOG_WORD(a), DLOG_MAP_5(__VA_ARGS__)
+#define DLOG_MAP_7(a, ...) DLOG_WORD(a), DLOG_MAP_6(__VA_ARGS__)
+#define DLOG_MAP_8(a, ...) DLOG_WORD(a), DLOG_MAP_7(__VA_ARGS__)
+
+/**
+ * method to store a log frame into the ring, frames are dropped when the
+ * ring is full. Use the DLOG macro instead of calling it directly.
+ *
+ * @param fmt format string located in the .dlog_fmt section
+ * @param args arguments
+ * @param nargs number of arguments
+ */
+extern void dlog_record(const char* fmt, const uint32_t* args, uint32_t nargs);
+
+/**
+ * method to write the pending frames to UART0 without blocking,
+ * should be called periodically from the background loop.
+ *
+ * @return number of bytes still pending in the ring
+ */
+extern uint32_t dlog_drain(void);
+
+/**
+ * method to get the total number of frames lost since startup
+ *
+ * @return number of lost frames
+ */
+extern uint32_t dlog_get_lost(void);
+
+#endif
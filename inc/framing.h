@@ -0,0 +1,175 @@
+#pragma once
+#ifndef FRAMING_H
+#define FRAMING_H
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Packet framing (COBS / SLIP) with CRC
+ *
+ * Purpose: This module implements COBS and SLIP packet framing protected
+ *          by an optional CRC-16 or CRC-32. Encoding is done in place in
+ *          the caller buffer; decoding is done byte by byte as data
+ *          arrive into a caller buffer, the CRC being computed on the fly,
+ *          and complete frames are delivered by pointer into that buffer.
+ *          The module has no hardware dependency besides the optional
+ *          framing_decoder_poll_uart helper.
+ *
+ *          CRC-16: CCITT (poly 0x1021, init 0xffff), appended big endian
+ *          CRC-32: IEEE 802.3 (reflected), appended little endian
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "am335x_uart.h"
+
+/**
+ * framing types
+ */
+enum framing_types {
+    FRAMING_COBS,  // consistent overhead byte stuffing, 0x00 delimiter
+    FRAMING_SLIP,  // RFC 1055 serial line ip, 0xc0 delimiter
+};
+
+/**
+ * frame check sequences
+ */
+enum framing_crcs {
+    FRAMING_CRC_NONE,
+    FRAMING_CRC16,
+    FRAMING_CRC32,
+};
+
+/**
+ * worst case size of an encoded frame for a given payload length,
+ * including the crc and the delimiter
+ */
+#define FRAMING_MAX_SIZE(len) (2 * ((len) + 4) + 2)
+
+/**
+ * Prototype of the frame delivery routine
+ *
+ * @param param application specific parameter
+ * @param frame payload of the frame (without crc), valid until return
+ * @param len payload length in bytes
+ */
+typedef void (*framing_handler_t)(void* param, uint8_t* frame, size_t len);
+
+/**
+ * streaming decoder state, to be initialized with framing_decoder_init
+ */
+struct framing_decoder {
+    enum framing_types type;
+    enum framing_crcs  crc_type;
+    uint8_t*           buf;      // caller buffer receiving the payload
+    size_t             size;     // size of the caller buffer
+    size_t             len;      // number of decoded bytes
+    uint32_t           crc;      // running crc over the decoded bytes
+    uint8_t            code;     // cobs: code of the current block
+    uint8_t            left;     // cobs: bytes left in the current block
+    bool               escape;   // slip: escape character received
+    bool               discard;  // frame in error, skip until delimiter
+    framing_handler_t  routine;
+    void*              param;
+    uint32_t           errors;   // frames discarded (crc, overflow, format)
+};
+
+/**
+ * method to compute a CRC-16 (CCITT) incrementally, start with 0xffff
+ *
+ * @param crc current crc value
+ * @param data data to add
+ * @param len number of bytes
+ * @return new crc value
+ */
+extern uint16_t framing_crc16(uint16_t crc, const void* data, size_t len);
+
+/**
+ * method to compute a CRC-32 (IEEE 802.3) incrementally, start with 0 and
+ * the result is the final crc value
+ *
+ * @param crc current crc value
+ * @param data data to add
+ * @param len number of bytes
+ * @return new crc value
+ */
+extern uint32_t framing_crc32(uint32_t crc, const void* data, size_t len);
+
+/**
+ * method to encode a frame in place: the crc is appended to the payload,
+ * the whole is encoded and terminated by the delimiter.
+ *
+ * @param type framing type
+ * @param crc_type frame check sequence
+ * @param buf buffer holding the payload at its beginning
+ * @param len payload length in bytes
+ * @param size size of the buffer (FRAMING_MAX_SIZE(len) is always enough)
+ * @return length of the encoded frame, 0 if the buffer is too small
+ */
+extern size_t framing_encode(enum framing_types type,
+                             enum framing_crcs crc_type,
+                             uint8_t* buf,
+                             size_t len,
+                             size_t size);
+
+/**
+ * method to initialize a streaming decoder
+ *
+ * @param dec decoder state
+ * @param type framing type
+ * @param crc_type frame check sequence
+ * @param buf buffer receiving the decoded frames
+ * @param size size of the buffer (payload + crc)
+ * @param routine frame delivery routine
+ * @param param application specific parameter
+ */
+extern void framing_decoder_init(struct framing_decoder* dec,
+                                 enum framing_types type,
+                                 enum framing_crcs crc_type,
+                                 uint8_t* buf,
+                                 size_t size,
+                                 framing_handler_t routine,
+                                 void* param);
+
+/**
+ * method to feed received bytes to a decoder, the delivery routine is
+ * called for each complete and valid frame. empty frames are ignored.
+ *
+ * @param dec decoder state
+ * @param data received bytes
+ * @param len number of bytes
+ */
+extern void framing_decoder_push(struct framing_decoder* dec,
+                                 const uint8_t* data,
+                                 size_t len);
+
+/**
+ * method to feed a decoder with the characters received by a uart
+ *
+ * @param dec decoder state
+ * @param ctrl am335x uart controller number
+ */
+static inline void framing_decoder_poll_uart(struct framing_decoder* dec,
+                                             enum am335x_uart_controllers ctrl) {
+    uint8_t chunk[64];
+    size_t  nb;
+    while ((nb = am335x_uart_read_buf(ctrl, chunk, sizeof(chunk))) > 0)
+        framing_decoder_push(dec, chunk, nb);
+}
+
+#endif
@@ -78,7 +78,15 @@ static inline void wr8(uint32_t* iobase, uint8_t value) {
     *(volatile uint8_t *)(iobase) = value;
 }
 
-#define kprintf printf
+/*
+ * heap free formatted output (see kprintf.c), kprintf writes to the
+ * console uart, ksnprintf into a caller buffer. %f requires KPRINTF_FLOAT.
+ */
+int kprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+int kvprintf(const char *fmt, va_list ap);
+int ksnprintf(char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
 
 void arm_flush_cache(uint32_t* addr, uint32_t length);
 void arm_icache_invalidate(uint32_t* addr, uint32_t length);
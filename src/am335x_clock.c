@@ -462,13 +462,13 @@ void am335x_clock_enable_uart_module(enum am335x_clock_uart_modules module) {
             break;
 
         case AM335X_CLOCK_UART1:
-            while (1) ;
+            enable_module(&per->uart1_clkctrl);
             break;
         case AM335X_CLOCK_UART2:
-            while (1) ;
+            enable_module(&per->uart2_clkctrl);
             break;
         case AM335X_CLOCK_UART3:
-            while (1) ;
+            enable_module(&per->uart3_clkctrl);
             break;
         case AM335X_CLOCK_UART4:
             enable_module(&per->uart4_clkctrl);
@@ -611,6 +611,29 @@ void am335x_clock_enable_mmc_module(enum am335x_clock_mmc_modules module) {
     }
 }
 
+/* -------------------------------------------------------------------------- */
+
+void am335x_clock_enable_edma_module() {
+    // enable edma channel controller and transfer controllers
+    enable_module(&per->tpcc_clkctrl);
+    enable_module(&per->tptc0_clkctrl);
+    enable_module(&per->tptc1_clkctrl);
+    enable_module(&per->tptc2_clkctrl);
+
+    // transfer controllers in non-idle / no-standby mode
+    *(volatile uint32_t*)0x49800010 = LE32(0x00000028);
+    *(volatile uint32_t*)0x49900010 = LE32(0x00000028);
+    *(volatile uint32_t*)0x49a00010 = LE32(0x00000028);
+
+    // wait for functionnal mode ACK
+    while ((per->tptc0_clkctrl & LE32(CM_PER_TPTC0_CLKCTRL_STBYST)) !=
+           LE32(CM_PER_TPTC0_CLKCTRL_STBYST_FUNC)) {}
+    while ((per->tptc1_clkctrl & LE32(CM_PER_TPTC1_CLKCTRL_STBYST)) !=
+           LE32(CM_PER_TPTC1_CLKCTRL_STBYST_FUNC)) {}
+    while ((per->tptc2_clkctrl & LE32(CM_PER_TPTC2_CLKCTRL_STBYST)) !=
+           LE32(CM_PER_TPTC2_CLKCTRL_STBYsST_FUNC)) {}
+}
+
 // Not Endian Corrected
 #if 0
 /* -----------------------------------------------------------------------------------
@@ -637,64 +660,6 @@ void am335x_clock_enable_epwm_module(enum am335x_clock_epwm_modules module)
     }
 }
 
-/* -----------------------------------------------------------------------------------
- */
-
-void am335x_clock_enable_edma_module()
-{
-    uint32_t* addr = NULL;
-
-    // enable module tpcc
-    enable_module(&per->tpcc_clkctrl);
-    wait4bit(&per->tpcc_clkctrl, CM_PER_TPCC_CLKCTRL_MODULEMODE_ENABLE);
-
-    // enable module tptc0
-    enable_module(&per->tptc0_clkctrl);
-    wait4bit(&per->tptc0_clkctrl, CM_PER_TPTC0_CLKCTRL_MODULEMODE_ENABLE);
-
-    // enable module tptc1
-    enable_module(&per->tptc1_clkctrl);
-    wait4bit(&per->tptc1_clkctrl, CM_PER_TPTC1_CLKCTRL_MODULEMODE_ENABLE);
-
-    // enable module tptc2
-    enable_module(&per->tptc2_clkctrl);
-    wait4bit(&per->tptc2_clkctrl, CM_PER_TPTC2_CLKCTRL_MODULEMODE_ENABLE);
-
-    // DMA in non-idle mode
-    addr  = (uint32_t*)0x49800010;
-    *addr = (uint32_t)0x00000028;
-    addr  = (uint32_t*)0x49900010;
-    *addr = (uint32_t)0x00000028;
-    addr  = (uint32_t*)0x49a00010;
-    *addr = (uint32_t)0x00000028;
-
-    // wait for functionnal mode ACK
-    while ((per->tpcc_clkctrl & CM_PER_TPCC_CLKCTRL_IDLEST) !=
-           CM_PER_TPCC_CLKCTRL_IDLEST_FUNC)
-        ;
-
-    while ((per->tptc0_clkctrl & CM_PER_TPCC_CLKCTRL_IDLEST) !=
-           CM_PER_TPCC_CLKCTRL_IDLEST_FUNC)
-        ;
-    while ((per->tptc0_clkctrl & CM_PER_TPCC_CLKCTRL_STBYST) !=
-           CM_PER_TPCC_CLKCTRL_STBYST_FUNC)
-        ;
-
-    while ((per->tptc1_clkctrl & CM_PER_TPCC_CLKCTRL_IDLEST) !=
-           CM_PER_TPCC_CLKCTRL_IDLEST_FUNC)
-        ;
-    while ((per->tptc1_clkctrl & CM_PER_TPCC_CLKCTRL_STBYST) !=
-           CM_PER_TPCC_CLKCTRL_STBYST_FUNC)
-        ;
-
-    while ((per->tptc2_clkctrl & CM_PER_TPCC_CLKCTRL_IDLEST) !=
-           CM_PER_TPCC_CLKCTRL_IDLEST_FUNC)
-        ;
-    while ((per->tptc2_clkctrl & CM_PER_TPCC_CLKCTRL_STBYST) !=
-           CM_PER_TPCC_CLKCTRL_STBYST_FUNC)
-        ;
-}
-
 /* -----------------------------------------------------------------------------------
  */
 
@@ -0,0 +1,261 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This module is based on the software library developped by Texas Instruments
+ * Incorporated - http://www.ti.com/ for its AM335x starter kit.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x EDMA3 Driver
+ *
+ * Purpose: This module implements basic services to drive the AM335x EDMA3
+ *          channel controller for event triggered peripheral transfers.
+ */
+
+#include "support.h"
+
+#include "am335x_edma.h"
+#include "am335x_clock.h"
+
+// define am335x edma3 channel controller global registers
+struct am335x_edma_cc {
+    uint32_t pid;            // 000
+    uint32_t cccfg;          // 004
+    uint32_t res1[62];       // 008-0fc
+    uint32_t dchmap[64];     // 100-1fc
+    uint32_t qchmap[8];      // 200-21c
+    uint32_t res2[8];        // 220-23c
+    uint32_t dmaqnum[8];     // 240-25c
+    uint32_t qdmaqnum;       // 260
+    uint32_t res3[8];        // 264-280
+    uint32_t quepri;         // 284
+    uint32_t res4[30];       // 288-2fc
+    uint32_t emr[2];         // 300-304
+    uint32_t emcr[2];        // 308-30c
+    uint32_t qemr;           // 310
+    uint32_t qemcr;          // 314
+    uint32_t ccerr;          // 318
+    uint32_t ccerrclr;       // 31c
+    uint32_t eeval;          // 320
+    uint32_t res5[7];        // 324-33c
+    uint32_t drae[8][2];     // 340-37c
+};
+
+// define am335x edma3 channel registers (global or shadow region)
+struct am335x_edma_region {
+    uint32_t er[2];          // 00-04
+    uint32_t ecr[2];         // 08-0c
+    uint32_t esr[2];         // 10-14
+    uint32_t cer[2];         // 18-1c
+    uint32_t eer[2];         // 20-24
+    uint32_t eecr[2];        // 28-2c
+    uint32_t eesr[2];        // 30-34
+    uint32_t ser[2];         // 38-3c
+    uint32_t secr[2];        // 40-44
+    uint32_t res1[2];        // 48-4c
+    uint32_t ier[2];         // 50-54
+    uint32_t iecr[2];        // 58-5c
+    uint32_t iesr[2];        // 60-64
+    uint32_t ipr[2];         // 68-6c
+    uint32_t icr[2];         // 70-74
+    uint32_t ieval;          // 78
+};
+
+// define am335x edma3 PaRAM set
+struct am335x_edma_paramset {
+    uint32_t opt;            // 00
+    uint32_t src;            // 04
+    uint32_t a_b_cnt;        // 08
+    uint32_t dst;            // 0c
+    uint32_t src_dst_bidx;   // 10
+    uint32_t link_bcntrld;   // 14
+    uint32_t src_dst_cidx;   // 18
+    uint32_t ccnt;           // 1c
+};
+
+// PaRAM OPT bit definition
+#define OPT_ITCCHEN            (1 << 23)
+#define OPT_TCCHEN             (1 << 22)
+#define OPT_ITCINTEN           (1 << 21)
+#define OPT_TCINTEN            (1 << 20)
+#define OPT_TCC_SHIFT          (12)
+#define OPT_TCC_MASK           (0x3f << 12)
+#define OPT_TCCMODE            (1 << 11)
+#define OPT_STATIC             (1 << 3)
+#define OPT_SYNCDIM            (1 << 2)
+#define OPT_DAM                (1 << 1)
+#define OPT_SAM                (1 << 0)
+
+// IEVAL register bit definition
+#define IEVAL_EVAL             (1 << 0)
+
+// am335x edma3 memory mapped access register pointers
+static volatile struct am335x_edma_cc* cc =
+    (struct am335x_edma_cc*)0x49000000;
+static volatile struct am335x_edma_region* region =
+    (struct am335x_edma_region*)0x49002000;  // shadow region 0
+static volatile struct am335x_edma_paramset* paramset =
+    (struct am335x_edma_paramset*)0x49004000;
+
+// control module event crossbar registers (tpcc_evt_mux_0_3...60_63)
+static volatile uint32_t* evt_mux = (uint32_t*)0x44e10f90;
+
+// completion handlers
+static struct edma_handler {
+    am335x_edma_handler_t routine;
+    void*                 param;
+} handlers[AM335X_EDMA_NB_CHANNELS];
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+void am335x_edma_init(void) {
+    static bool is_initialized = false;
+    if (is_initialized) return;
+
+    am335x_clock_enable_edma_module();
+
+    // map each channel to its own PaRAM set, all of them on queue 0
+    for (int i = 0; i < AM335X_EDMA_NB_CHANNELS; i++) {
+        cc->dchmap[i] = LE32(i << 5);
+    }
+    for (int i = 0; i < 8; i++) cc->dmaqnum[i] = LE32(0);
+
+    // give all channels to shadow region 0 and clear pending states
+    cc->drae[0][0] = LE32(0xffffffff);
+    cc->drae[0][1] = LE32(0xffffffff);
+    for (int i = 0; i < 2; i++) {
+        region->eecr[i] = LE32(0xffffffff);
+        region->ecr[i]  = LE32(0xffffffff);
+        region->secr[i] = LE32(0xffffffff);
+        region->iecr[i] = LE32(0xffffffff);
+        region->icr[i]  = LE32(0xffffffff);
+        cc->emcr[i]     = LE32(0xffffffff);
+    }
+    cc->ccerrclr = LE32(0xffffffff);
+
+    is_initialized = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_map_event(uint32_t channel, uint32_t xbar_event) {
+    volatile uint32_t* mux   = &evt_mux[channel / 4];
+    uint32_t           shift = (channel % 4) * 8;
+    *mux = (*mux & ~LE32(0x3f << shift)) | LE32((xbar_event & 0x3f) << shift);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_attach(uint32_t channel, am335x_edma_handler_t routine,
+                        void* param) {
+    uint32_t bit = 1 << (channel % 32);
+
+    region->iecr[channel / 32] = LE32(bit);
+    handlers[channel].routine  = routine;
+    handlers[channel].param    = param;
+    if (routine != 0) region->iesr[channel / 32] = LE32(bit);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_setup(uint32_t entry, const struct am335x_edma_transfer* xfer) {
+    volatile struct am335x_edma_paramset* set = &paramset[entry];
+
+    uint32_t opt = (xfer->tcc << OPT_TCC_SHIFT) & OPT_TCC_MASK;
+    if (xfer->interrupt) opt |= OPT_TCINTEN;
+
+    uint32_t link = xfer->link;
+    if (link != AM335X_EDMA_NO_LINK) link = 0x4000 + link * 32;
+
+    set->opt          = LE32(opt);
+    set->src          = LE32((uint32_t)xfer->src);
+    set->a_b_cnt      = LE32((xfer->bcnt << 16) | xfer->acnt);
+    set->dst          = LE32((uint32_t)xfer->dst);
+    set->src_dst_bidx = LE32(((uint16_t)xfer->dst_bidx << 16) |
+                             (uint16_t)xfer->src_bidx);
+    set->link_bcntrld = LE32((xfer->bcnt << 16) | link);
+    set->src_dst_cidx = LE32(0);
+    set->ccnt         = LE32(1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t am335x_edma_remaining(uint32_t entry) {
+    return LE32(paramset[entry].a_b_cnt) >> 16;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_enable(uint32_t channel) {
+    region->eesr[channel / 32] = LE32(1 << (channel % 32));
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_disable(uint32_t channel) {
+    region->eecr[channel / 32] = LE32(1 << (channel % 32));
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_clear(uint32_t channel) {
+    uint32_t bit = 1 << (channel % 32);
+
+    region->ecr[channel / 32]  = LE32(bit);
+    region->secr[channel / 32] = LE32(bit);
+    cc->emcr[channel / 32]     = LE32(bit);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_mask_interrupt(uint32_t channel) {
+    region->iecr[channel / 32] = LE32(1 << (channel % 32));
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_unmask_interrupt(uint32_t channel) {
+    region->iesr[channel / 32] = LE32(1 << (channel % 32));
+
+    // raise the interrupt again if a completion occurred while masked
+    region->ieval = LE32(IEVAL_EVAL);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_trigger(uint32_t channel) {
+    region->esr[channel / 32] = LE32(1 << (channel % 32));
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_edma_interrupt_handler(void) {
+    for (int i = 0; i < 2; i++) {
+        uint32_t pending;
+        while ((pending = LE32(region->ipr[i]) & LE32(region->ier[i])) != 0) {
+            uint32_t bit = __builtin_ctz(pending);
+            region->icr[i] = LE32(1 << bit);
+
+            struct edma_handler* handler = &handlers[i * 32 + bit];
+            if (handler->routine != 0)
+                handler->routine(i * 32 + bit, handler->param);
+        }
+    }
+
+    // re-evaluate pending interrupts raised during processing
+    region->ieval = LE32(IEVAL_EVAL);
+}
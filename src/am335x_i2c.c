@@ -27,10 +27,16 @@
  * Date:    03.07.2015
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "support.h"
 
 #include "am335x_i2c.h"
 #include "am335x_clock.h"
+#include "am335x_dmtimer1.h"
+#include "am335x_edma.h"
+#include "am335x_irq.h"
 #include "am335x_mux.h"
 
 // define am335x i2c controller registers
@@ -106,6 +112,20 @@ struct am335x_i2c_ctrl {
 #define IRQSTATUS_RAW_NACK             (1 << 1)
 #define IRQSTATUS_RAW_AL               (1 << 0)
 
+// interrupts driving the asynchronous transactions
+#define ASYNC_IRQS                                                       \
+    (IRQSTATUS_RAW_XDR | IRQSTATUS_RAW_RDR | IRQSTATUS_RAW_XRDY |        \
+     IRQSTATUS_RAW_RRDY | IRQSTATUS_RAW_ARDY | IRQSTATUS_RAW_NACK |      \
+     IRQSTATUS_RAW_AL)
+
+// transfer errors: not acknowledged, arbitration lost and access error
+#define ERROR_IRQS \
+    (IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_AL | IRQSTATUS_RAW_AERR)
+
+// fifo interrupts: transmit/receive ready and draining
+#define TX_IRQS                        (IRQSTATUS_RAW_XRDY | IRQSTATUS_RAW_XDR)
+#define RX_IRQS                        (IRQSTATUS_RAW_RRDY | IRQSTATUS_RAW_RDR)
+
 // I2C CON register bit definition
 #define CON_I2C_EN                     (1 << 15)
 
@@ -126,6 +146,15 @@ struct am335x_i2c_ctrl {
 #define CON_STP                        (1 << 1)
 #define CON_STT                        (1 << 0)
 
+// I2C OA register bit definition
+#define OA_MCODE_MASK                  (0x7 << 13)
+#define OA_MCODE_SHIFT                 (13)
+
+// I2C SCLL & SCLH register bit definition
+#define SCL_HS_SHIFT                   (8)  // high speed phase in bits 15:8
+#define SCLL_OFFSET                    7    // tLOW  = (SCLL + 7) * ICLK period
+#define SCLH_OFFSET                    5    // tHIGH = (SCLH + 5) * ICLK period
+
 // I2C BUF register bit definition
 #define BUF_RDMA_EN                    (1 << 15)
 #define BUF_RXFIFO_CLR                 (1 << 14)
@@ -136,12 +165,66 @@ struct am335x_i2c_ctrl {
 #define BUF_TXTRSH_MASK                (0x3f << 0)
 #define BUF_TXTRSH_SHIFT               (0)
 
-// I2C BUF register bit definition
+// I2C DMARXENABLE_SET/CLR & DMATXENABLE_SET/CLR register bit definition
+#define DMAENABLE_TRANSFER             (1 << 0)
+
+// I2C BUFSTAT register bit definition
+#define BUFSTAT_FIFODEPTH_MASK         (0x3 << 14)
+#define BUFSTAT_FIFODEPTH_SHIFT        (14)
+#define BUFSTAT_RXSTAT_MASK            (0x3f << 8)
+#define BUFSTAT_RXSTAT_SHIFT           (8)
+#define BUFSTAT_TXSTAT_MASK            (0x3f << 0)
+#define BUFSTAT_TXSTAT_SHIFT           (0)
+
+// I2C SYSS register bit definition
 #define SYSS_RDONE                     (1 << 0)
 
+// I2C SYSTEST register bit definition
+#define SYSTEST_ST_EN                  (1 << 15)
+#define SYSTEST_FREE                   (1 << 14)
+#define SYSTEST_TMODE_MASK             (0x3 << 12)
+#define SYSTEST_TMODE_FUNCTIONAL       (0x0 << 12)
+#define SYSTEST_TMODE_SCL_COUNTERS     (0x2 << 12)
+#define SYSTEST_TMODE_IO               (0x3 << 12)  // scl/sda driven by sw
+#define SYSTEST_SCL_I                  (1 << 3)
+#define SYSTEST_SCL_O                  (1 << 2)
+#define SYSTEST_SDA_I                  (1 << 1)
+#define SYSTEST_SDA_O                  (1 << 0)
+
+// wait deadlines: a transfer may last twice its nominal duration (9 bits
+// per byte) plus a margin for the clock stretching of the slaves
+#define TIMEOUT_MARGIN_US              1000
+#define BUS_BUSY_TIMEOUT_US            25000  // smbus clock low timeout
+
+// range of the scanned chip addresses, reserved addresses excluded
+#define SCAN_FIRST                     0x08
+#define SCAN_LAST                      0x77
+
+// bus recovery: clock pulses needed to complete any pending byte
+#define RECOVERY_PULSES                9
+#define RECOVERY_HALF_PERIOD_US        5  // 100 kHz
+
 // i2c clocking values
 #define SYSTEM_CLOCK                   48000000
 #define INTERNAL_CLOCK                 12000000
+#define FS_SPEED_MAX                   400000  // speed of the hs master code
+#define HS_MASTER_CODE                 0  // master code 00001xxx, xxx=0..7
+
+// i2c bus speed modes, the scl low time is lengthened in fast modes to
+// satisfy the minimum low periods of the i2c specification
+static const struct i2c_speed_mode {
+    uint32_t max_speed;  // highest bus speed of the mode in Hz
+    uint32_t iclk;       // preferred internal clock in Hz
+    uint32_t low_pct;    // scl low time in percent of the period
+    uint32_t opmode;     // controller operation mode
+} speed_modes[] = {
+    {100000, INTERNAL_CLOCK, 50, CON_OPMODE_FSI2C},   // standard mode
+    {400000, INTERNAL_CLOCK, 66, CON_OPMODE_FSI2C},   // fast mode
+    {1000000, 24000000, 66, CON_OPMODE_FSI2C},        // fast mode plus
+    {3400000, SYSTEM_CLOCK, 66, CON_OPMODE_HSI2C},    // high speed mode
+};
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 // am335x uart controllers memory mapped access register pointers
 static volatile struct am335x_i2c_ctrl* i2c_ctrl[] = {
@@ -164,34 +247,130 @@ static const enum am335x_mux_i2c_modules i2c2mux[] = {
     AM335X_MUX_I2C2,
 };
 
+// table to convert i2c interface to interrupt number
+static const uint32_t i2c2irq[] = {
+    SYS_INT_I2C0INT,
+    //  SYS_INT_I2C1INT,
+    SYS_INT_I2C2INT,
+};
+
+// table to convert i2c interface to dma channels
+static const struct i2c_dma_events {
+    uint32_t tx;       // tx dma channel
+    uint32_t rx;       // rx dma channel
+    uint32_t tx_xbar;  // tx crossbar event (0 for direct event)
+    uint32_t rx_xbar;  // rx crossbar event (0 for direct event)
+} i2c2dma[] = {
+    {58, 59, 0, 0},
+    //  {60, 61, 0, 0},
+    {3, 4, 3, 4},
+};
+
+// completion conditions of a transaction phase
+#define WAIT_BUS                       (1 << 0)  // transfer done on the bus
+#define WAIT_DMA                       (1 << 1)  // data moved by the dma
+#define WAIT_STOP                      (1 << 2)  // stop of an aborted transfer
+
+// phases of an asynchronous transaction
+enum i2c_phases {
+    PHASE_REG,   // sending the register address (and the data to write)
+    PHASE_DATA,  // receiving the data
+};
+
+// asynchronous transaction queue of each controller
+static struct i2c_port {
+    struct am335x_i2c_request* head;         // request in progress
+    struct am335x_i2c_request* tail;         // last queued request
+    enum i2c_phases            phase;        // phase of the request in progress
+    uint32_t                   index;        // bytes transferred in this phase
+    uint32_t                   threshold;    // fifo threshold of this phase
+    uint32_t                   fifo_size;    // size of the hardware fifos
+    uint32_t                   wait;         // pending completion conditions
+    int                        error;        // status of the aborted request
+    uint32_t                   requested;    // requested scl frequency in Hz
+    uint32_t                   bus_speed;    // achieved scl frequency in Hz
+    bool                       dma;          // dma channels attached
+    struct am335x_i2c_request  scan;         // probe request of the bus scan
+    uint8_t                    scan_data;    // byte read by the probe
+    uint32_t                   scan_limit;   // deadline of the probe
+    int                        scan_status;  // first scan error
+    bool                       scanned;      // devices holds a scan result
+    struct am335x_i2c_devices  devices;      // chips found by the last scan
+} ports[2];
+
 /* --------------------------------------------------------------------------
  * implementation of local methods
  * -------------------------------------------------------------------------- */
 
+/**
+ * method to compute a deadline in DMTimer1 ticks
+ *
+ *@param us delay from now in microseconds
+ */
+static inline uint32_t deadline(uint32_t us) {
+    return am335x_dmtimer1_get_counter() +
+           us * (am335x_dmtimer1_get_frequency() / 1000000);
+}
+
+static inline bool expired(uint32_t limit) {
+    return (int32_t)(am335x_dmtimer1_get_counter() - limit) >= 0;
+}
+
+/**
+ * method to compute the timeout of a wait for the transfer of the specified
+ * number of bytes, the slave address byte included
+ *
+ *@return timeout in microseconds
+ */
+static uint32_t transfer_timeout(enum am335x_i2c_controllers ctrl,
+                                 uint32_t nb_bytes) {
+    uint32_t speed = ports[ctrl].bus_speed;
+    if (speed == 0) speed = speed_modes[0].max_speed;
+    return TIMEOUT_MARGIN_US +
+           (uint64_t)2 * (nb_bytes + 1) * 9 * 1000000 / speed;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to convert the error bits of the irqstatus_raw register
+ *
+ *@return 0 if no error, the error code otherwise
+ */
+static int bus_error(uint32_t status) {
+    if ((status & IRQSTATUS_RAW_NACK) != 0) return AM335X_I2C_ENACK;
+    if ((status & IRQSTATUS_RAW_AL) != 0) return AM335X_I2C_EARB;
+    if ((status & IRQSTATUS_RAW_AERR) != 0) return AM335X_I2C_EACCESS;
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /**
  * method to wait until specified bit is set in the irqstatus_raw register
  *
  *@param i2c i2c controller
  *@param bit bit to wait for (mask)
- *@return status information: 0 --> bit is set, -1 --> error has been detected
+ *@param timeout_us maximum waiting time in microseconds
+ *@return status information: 0 --> bit is set, error code otherwise
  */
-static int wait_for_status(volatile struct am335x_i2c_ctrl* i2c, int bit) {
-    int status  = 0;
-    int timeout = 20000;
+static int wait_for_status(volatile struct am335x_i2c_ctrl* i2c, uint32_t bit,
+                           uint32_t timeout_us) {
+    uint32_t limit  = deadline(timeout_us);
+    int      status = 0;
     while (1) {
         // check for malfunction...
-        status = -1;
-        if ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_AL)) != 0) break;
-        if ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_AERR)) != 0)
-            break;
-        if (timeout == 0)
-            break;
-        else
-            timeout--;
+        uint32_t raw = LE32(i2c->irqstatus_raw);
+        status       = bus_error(raw);
+        if (status != 0) break;
 
         // check for valid bit...
-        status = 0;
-        if ((i2c->irqstatus_raw & LE32(bit)) != 0) break;
+        if ((raw & bit) != 0) break;
+
+        if (expired(limit)) {
+            status = AM335X_I2C_ETIMEOUT;
+            break;
+        }
     }
 
     // clear error bits
@@ -201,6 +380,551 @@ static int wait_for_status(volatile struct am335x_i2c_ctrl* i2c, int bit) {
     return status;
 }
 
+/**
+ * method to wait until the bus is free
+ *
+ *@return status information: 0 --> bus free, error code otherwise
+ */
+static int wait_bus_idle(volatile struct am335x_i2c_ctrl* i2c,
+                         uint32_t timeout_us) {
+    uint32_t limit = deadline(timeout_us);
+    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_BB)) != 0) {
+        if (expired(limit)) return AM335X_I2C_ETIMEOUT;
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to compute the scl low and high times for a given internal clock,
+ * the period is rounded up so that the requested speed is never exceeded
+ *
+ *@return achieved scl frequency in Hz, 0 if not reachable
+ */
+static uint32_t scl_timing(uint32_t iclk, uint32_t speed, uint32_t low_pct,
+                           uint32_t* scll, uint32_t* sclh) {
+    uint32_t total = (iclk + speed - 1) / speed;
+    uint32_t low   = (total * low_pct + 50) / 100;
+    if (total - low < SCLH_OFFSET) low = total - SCLH_OFFSET;
+    uint32_t high = total - low;
+    if ((total < SCLL_OFFSET + SCLH_OFFSET) || (low < SCLL_OFFSET) ||
+        (low - SCLL_OFFSET > 0xff) || (high - SCLH_OFFSET > 0xff))
+        return 0;
+
+    *scll = low - SCLL_OFFSET;
+    *sclh = high - SCLH_OFFSET;
+    return iclk / total;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to clear the fifos and to program their thresholds for a transfer
+ * of the specified length. half of the fifo is used, so that it can be
+ * filled or drained while the other half is being transferred.
+ *
+ *@return fifo threshold in bytes
+ */
+static uint32_t fifo_threshold(enum am335x_i2c_controllers ctrl,
+                               uint32_t len) {
+    uint32_t threshold = ports[ctrl].fifo_size / 2;
+    if (threshold > len) threshold = len;
+    if (threshold == 0) threshold = 1;
+    return threshold;
+}
+
+static uint32_t setup_fifo(enum am335x_i2c_controllers ctrl, uint32_t len) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    uint32_t threshold = fifo_threshold(ctrl, len);
+    i2c->buf = LE32(BUF_RXFIFO_CLR | BUF_TXFIFO_CLR |
+                    ((threshold - 1) << BUF_RXTRSH_SHIFT) |
+                    ((threshold - 1) << BUF_TXTRSH_SHIFT));
+    return threshold;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to get the number of bytes to write into the tx fifo: the
+ * threshold on XRDY, the remaining bytes of the transfer on XDR
+ */
+static uint32_t tx_room(volatile struct am335x_i2c_ctrl* i2c, uint32_t status,
+                        uint32_t threshold) {
+    if ((status & IRQSTATUS_RAW_XDR) == 0) return threshold;
+    return (LE32(i2c->bufstat) & BUFSTAT_TXSTAT_MASK) >> BUFSTAT_TXSTAT_SHIFT;
+}
+
+/**
+ * method to get the number of bytes available in the rx fifo: the
+ * threshold on RRDY, the remaining bytes of the transfer on RDR
+ */
+static uint32_t rx_level(volatile struct am335x_i2c_ctrl* i2c, uint32_t status,
+                         uint32_t threshold) {
+    if ((status & IRQSTATUS_RAW_RDR) == 0) return threshold;
+    return (LE32(i2c->bufstat) & BUFSTAT_RXSTAT_MASK) >> BUFSTAT_RXSTAT_SHIFT;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to send the register address (msb first) followed by the data
+ * bytes by chunks, stops early if the transfer has been aborted
+ *
+ *@return status information: 0 --> bytes sent, error code otherwise
+ */
+static int send_bytes(enum am335x_i2c_controllers ctrl, uint32_t threshold,
+                      uint32_t reg, uint32_t reg_size, const uint8_t* data,
+                      uint32_t data_len) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    uint32_t len = reg_size + data_len;
+    while (len > 0) {
+        // wait for room in the tx fifo
+        uint32_t limit = deadline(transfer_timeout(ctrl, threshold));
+        uint32_t status;
+        while (((status = LE32(i2c->irqstatus_raw)) &
+                (TX_IRQS | ERROR_IRQS)) == 0) {
+            if (expired(limit)) return AM335X_I2C_ETIMEOUT;
+        }
+        if ((status & ERROR_IRQS) != 0) return bus_error(status);
+
+        uint32_t nb = tx_room(i2c, status, threshold);
+        if (nb > len) nb = len;
+        len -= nb;
+        while (nb-- > 0) {
+            if (reg_size > 0)
+                i2c->data = LE32((reg >> (8 * --reg_size)) & 0xff);
+            else
+                i2c->data = LE32(*data++);
+        }
+        i2c->irqstatus = LE32(status & TX_IRQS);
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to receive data bytes by chunks, stops early if the transfer has
+ * been aborted
+ *
+ *@return status information: 0 --> bytes received, error code otherwise
+ */
+static int receive_bytes(enum am335x_i2c_controllers ctrl, uint32_t threshold,
+                         uint8_t* data, uint32_t len) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    while (len > 0) {
+        // wait for data in the rx fifo
+        uint32_t limit = deadline(transfer_timeout(ctrl, threshold));
+        uint32_t status;
+        while (((status = LE32(i2c->irqstatus_raw)) &
+                (RX_IRQS | ERROR_IRQS)) == 0) {
+            if (expired(limit)) return AM335X_I2C_ETIMEOUT;
+        }
+        if ((status & ERROR_IRQS) != 0) return bus_error(status);
+
+        uint32_t nb = rx_level(i2c, status, threshold);
+        if (nb > len) nb = len;
+        len -= nb;
+        while (nb-- > 0) *data++ = LE32(i2c->data);
+        i2c->irqstatus = LE32(status & RX_IRQS);
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to reset the controller, it is left disabled
+ */
+static void reset_controller(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    // reset and disable i2c controller
+    i2c->sysc = LE32(SYSC_SRST);
+    while ((i2c->syss & LE32(SYSS_RDONE)) != 0) {}
+    i2c->con &= ~LE32(CON_I2C_EN);
+
+    // configure clock activity and idle mode
+    i2c->sysc = LE32(SYSC_IDLEMODE_NOIDLE | SYSC_CLKACTIVITY_BOTH);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to drive the scl and sda lines by software during half a period
+ */
+static void drive_lines(volatile struct am335x_i2c_ctrl* i2c, uint32_t lines) {
+    i2c->systest = LE32(SYSTEST_ST_EN | SYSTEST_TMODE_IO | lines);
+    am335x_dmtimer1_wait_us(RECOVERY_HALF_PERIOD_US);
+}
+
+/**
+ * method to free a bus held by a slave stuck in the middle of a byte: scl
+ * is pulsed until the slave releases sda (9 pulses at most), then a stop
+ * condition is generated and the controller is reset.
+ */
+static void bus_recovery(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    // take control of the lines, both released
+    drive_lines(i2c, SYSTEST_SCL_O | SYSTEST_SDA_O);
+
+    // clock out the pending bits until sda is released
+    for (int i = 0; i < RECOVERY_PULSES; i++) {
+        if ((LE32(i2c->systest) & SYSTEST_SDA_I) != 0) break;
+        drive_lines(i2c, SYSTEST_SDA_O);
+        drive_lines(i2c, SYSTEST_SCL_O | SYSTEST_SDA_O);
+    }
+
+    // stop condition: sda rising while scl is high
+    drive_lines(i2c, SYSTEST_SDA_O);
+    drive_lines(i2c, 0);
+    drive_lines(i2c, SYSTEST_SCL_O);
+    drive_lines(i2c, SYSTEST_SCL_O | SYSTEST_SDA_O);
+
+    // back to functional mode with a clean controller state
+    i2c->systest = 0;
+    reset_controller(ctrl);
+    am335x_i2c_set_bus_speed(ctrl, ports[ctrl].requested);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to wait until the bus is free, a bus kept busy beyond the timeout
+ * is considered stuck and recovered
+ *
+ *@return status information: 0 --> bus free, error code otherwise
+ */
+static int wait_bus_free(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    if (wait_bus_idle(i2c, BUS_BUSY_TIMEOUT_US) == 0) return 0;
+    bus_recovery(ctrl);
+    if (wait_bus_idle(i2c, transfer_timeout(ctrl, 0)) == 0) return 0;
+    return AM335X_I2C_EBUSY;
+}
+
+/**
+ * method to terminate a polled transfer: on error the bus is released with
+ * a stop condition, a stuck transfer is aborted by a bus recovery
+ *
+ *@return status of the transfer
+ */
+static int end_transfer(enum am335x_i2c_controllers ctrl, int status) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    if ((status == AM335X_I2C_ENACK) || (status == AM335X_I2C_EACCESS)) {
+        // the stop bit is cleared by the controller once generated
+        if ((i2c->con & LE32(CON_MST)) != 0) i2c->con |= LE32(CON_STP);
+        if (wait_bus_idle(i2c, transfer_timeout(ctrl, 0)) != 0)
+            bus_recovery(ctrl);
+    } else if (status == AM335X_I2C_ETIMEOUT) {
+        bus_recovery(ctrl);
+    }
+
+    // acknowlegde all status information
+    i2c->irqstatus = i2c->irqstatus_raw;
+
+    return status;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to protect the transaction queue against the i2c interrupt
+ */
+static void port_lock(enum am335x_i2c_controllers ctrl) {
+    IntSystemDisable(i2c2irq[ctrl]);
+    (void)IntRawStatusGet(i2c2irq[ctrl]);  // make sure the mask is set
+    if (ports[ctrl].dma) am335x_edma_mask_interrupt(i2c2dma[ctrl].rx);
+}
+
+static void port_unlock(enum am335x_i2c_controllers ctrl) {
+    IntSystemEnable(i2c2irq[ctrl]);
+    if (ports[ctrl].dma) am335x_edma_unmask_interrupt(i2c2dma[ctrl].rx);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to let the dma move the data of the current phase: the fifo
+ * threshold is set to one byte and each dma event moves one byte.
+ * only the transfer end and the errors remain signaled by interrupt.
+ */
+static void dma_start(enum am335x_i2c_controllers ctrl, bool read,
+                      uint8_t* data, uint16_t len) {
+    volatile struct am335x_i2c_ctrl* i2c     = i2c_ctrl[ctrl];
+    uint32_t                         channel = read ? i2c2dma[ctrl].rx
+                                                    : i2c2dma[ctrl].tx;
+
+    // make the data visible to the dma controller
+    arm_flush_cache((uint32_t*)data, len);
+
+    struct am335x_edma_transfer xfer = {
+        .src       = read ? (const volatile void*)&i2c->data : data,
+        .dst       = read ? (volatile void*)data : &i2c->data,
+        .acnt      = 1,
+        .bcnt      = len,
+        .src_bidx  = read ? 0 : 1,
+        .dst_bidx  = read ? 1 : 0,
+        .link      = AM335X_EDMA_NO_LINK,
+        .tcc       = channel,
+        .interrupt = read,
+    };
+    am335x_edma_setup(channel, &xfer);
+    am335x_edma_enable(channel);
+
+    i2c->irqenable_clr = LE32(TX_IRQS | RX_IRQS);
+    if (read) {
+        i2c->buf |= LE32(BUF_RDMA_EN);
+        i2c->dmarxenable_set = LE32(DMAENABLE_TRANSFER);
+        ports[ctrl].wait |= WAIT_DMA;
+    } else {
+        i2c->buf |= LE32(BUF_XDMA_EN);
+        i2c->dmatxenable_set = LE32(DMAENABLE_TRANSFER);
+    }
+}
+
+/**
+ * method to stop the dma of the current phase
+ */
+static void dma_stop(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    i2c->dmarxenable_clr = LE32(DMAENABLE_TRANSFER);
+    i2c->dmatxenable_clr = LE32(DMAENABLE_TRANSFER);
+    i2c->buf &= ~LE32(BUF_RDMA_EN | BUF_XDMA_EN);
+    am335x_edma_disable(i2c2dma[ctrl].tx);
+    am335x_edma_disable(i2c2dma[ctrl].rx);
+    am335x_edma_clear(i2c2dma[ctrl].tx);
+    am335x_edma_clear(i2c2dma[ctrl].rx);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to get the byte at the specified position of a request, the
+ * register address (msb first) is followed by the data to write
+ */
+static inline uint8_t request_byte(const struct am335x_i2c_request* req,
+                                   uint32_t index) {
+    if (index < req->reg_size)
+        return req->reg >> (8 * (req->reg_size - 1 - index));
+    return req->data[index - req->reg_size];
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to start the reception of the data of a read request
+ */
+static void start_data_phase(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c  = i2c_ctrl[ctrl];
+    struct i2c_port*                 port = &ports[ctrl];
+    struct am335x_i2c_request*       req  = port->head;
+
+    port->phase     = PHASE_DATA;
+    port->index     = 0;
+    port->wait      = WAIT_BUS;
+    port->threshold = setup_fifo(ctrl, req->dma ? 1 : req->data_len);
+    if (req->dma) dma_start(ctrl, true, req->data, req->data_len);
+
+    // initiate read data transfer with a (repeated) start condition
+    i2c->cnt = LE32(req->data_len);
+    i2c->con = (i2c->con & ~LE32(CON_TRX)) | LE32(CON_MST | CON_STT | CON_STP);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to start the request at the head of the queue, the register
+ * address is sent first (followed by the data for a write)
+ */
+static void start_request(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c  = i2c_ctrl[ctrl];
+    struct i2c_port*                 port = &ports[ctrl];
+    struct am335x_i2c_request*       req  = port->head;
+
+    // a read without register address starts with the data phase
+    if (req->read && (req->reg_size == 0)) {
+        i2c->irqstatus     = LE32(ASYNC_IRQS | IRQSTATUS_RAW_BF);
+        i2c->sa            = LE32(req->chip_id);
+        i2c->irqenable_set = LE32(ASYNC_IRQS);
+        start_data_phase(ctrl);
+        return;
+    }
+
+    uint32_t len = req->reg_size + (req->read ? 0 : req->data_len);
+    bool     dma = req->dma && !req->read && (req->data_len > 0);
+
+    port->phase     = PHASE_REG;
+    port->index     = 0;
+    port->wait      = WAIT_BUS;
+    port->threshold = setup_fifo(ctrl, dma ? 1 : len);
+
+    // clear former pending status flags
+    i2c->irqstatus = LE32(ASYNC_IRQS | IRQSTATUS_RAW_BF);
+
+    // set slave address and number of bytes to transfer
+    i2c->sa  = LE32(req->chip_id);
+    i2c->cnt = LE32(len);
+
+    // with dma the register address is queued first, the data follow
+    i2c->irqenable_set = LE32(ASYNC_IRQS);
+    if (dma) {
+        while (port->index < req->reg_size)
+            i2c->data = LE32(request_byte(req, port->index++));
+        port->index = len;
+        dma_start(ctrl, false, req->data, req->data_len);
+    }
+
+    // start transfer as master & transmitter, a read continues with a
+    // repeated start condition
+    i2c->con |= LE32(CON_MST | CON_TRX | CON_STT | (req->read ? 0 : CON_STP));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to append a request to the queue, it is started at once if the
+ * controller is idle. the caller must hold the port lock or run in the
+ * completion handler of the port.
+ */
+static void queue_request(enum am335x_i2c_controllers ctrl,
+                          struct am335x_i2c_request* req) {
+    struct i2c_port* port = &ports[ctrl];
+
+    req->next   = 0;
+    req->done   = false;
+    req->status = 0;
+
+    if (port->tail == 0) {
+        port->head = req;
+        port->tail = req;
+        start_request(ctrl);
+    } else {
+        port->tail->next = req;
+        port->tail       = req;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to complete the request in progress and to start the next one
+ */
+static void complete_request(enum am335x_i2c_controllers ctrl, int status) {
+    volatile struct am335x_i2c_ctrl* i2c  = i2c_ctrl[ctrl];
+    struct i2c_port*                 port = &ports[ctrl];
+    struct am335x_i2c_request*       req  = port->head;
+
+    if (req->dma) {
+        dma_stop(ctrl);
+        if (req->read)
+            arm_dcache_invalidate((uint32_t*)req->data, req->data_len);
+    }
+
+    port->head = req->next;
+    if (port->head != 0) {
+        start_request(ctrl);
+    } else {
+        port->tail         = 0;
+        i2c->irqenable_clr = LE32(ASYNC_IRQS);
+    }
+
+    req->status = status;
+    req->done   = true;
+    if (req->routine != 0) req->routine(ctrl, req, req->param);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to fail the request in progress once its stop condition has been
+ * generated: the next request may only be started on a free bus, so the
+ * transfer interrupts are replaced by the bus free one until then
+ */
+static void fail_request(enum am335x_i2c_controllers ctrl, int status) {
+    volatile struct am335x_i2c_ctrl* i2c  = i2c_ctrl[ctrl];
+    struct i2c_port*                 port = &ports[ctrl];
+
+    port->wait         = WAIT_STOP;
+    port->error        = status;
+    i2c->irqenable_clr = LE32(ASYNC_IRQS);
+    i2c->irqenable_set = LE32(IRQSTATUS_RAW_BF);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * dma completion handler, all data of a read request have been received
+ */
+static void dma_rx_done(uint32_t channel, void* param) {
+    struct i2c_port*            port = param;
+    enum am335x_i2c_controllers ctrl = port - ports;
+    (void)channel;
+
+    if ((port->head == 0) || ((port->wait & WAIT_DMA) == 0)) return;
+    port->wait &= ~WAIT_DMA;
+    if (port->wait == 0) complete_request(ctrl, 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to attach the dma channels of a controller
+ */
+static void dma_init(enum am335x_i2c_controllers ctrl) {
+    const struct i2c_dma_events* dma = &i2c2dma[ctrl];
+
+    am335x_edma_init();
+    if (dma->tx_xbar != 0) am335x_edma_map_event(dma->tx, dma->tx_xbar);
+    if (dma->rx_xbar != 0) am335x_edma_map_event(dma->rx, dma->rx_xbar);
+    am335x_edma_clear(dma->tx);
+    am335x_edma_clear(dma->rx);
+    am335x_edma_attach(dma->rx, dma_rx_done, &ports[ctrl]);
+    ports[ctrl].dma = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to abort the request in progress, the bus is recovered
+ */
+static void abort_request(enum am335x_i2c_controllers ctrl, int status) {
+    bus_recovery(ctrl);
+    complete_request(ctrl, status);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * scan probe completion handler: the answer of the chip is recorded and
+ * the next address is probed. the probe is requeued directly since the
+ * handler runs either in interrupt context or under the port lock.
+ */
+static void scan_done(enum am335x_i2c_controllers ctrl,
+                      struct am335x_i2c_request* req, void* param) {
+    struct i2c_port* port = &ports[ctrl];
+    (void)param;
+
+    if (req->status == 0)
+        port->devices.map[req->chip_id / 32] |= 1u << (req->chip_id % 32);
+    else if ((req->status != AM335X_I2C_ENACK) && (port->scan_status == 0))
+        port->scan_status = req->status;
+
+    if (req->chip_id < SCAN_LAST) {
+        req->chip_id++;
+        port->scan_limit = deadline(transfer_timeout(ctrl, 1));
+        queue_request(ctrl, req);
+    }
+}
+
 /* --------------------------------------------------------------------------
  * implementation of the public methods
  * -------------------------------------------------------------------------- */
@@ -214,145 +938,271 @@ void am335x_i2c_init(enum am335x_i2c_controllers ctrl, uint32_t bus_speed) {
     // setup i2c pins
     am335x_mux_setup_i2c_pins(i2c2mux[ctrl]);
 
-    // reset and disable i2c controller
-    i2c->sysc = LE32(SYSC_SRST);
-    while ((i2c->syss & LE32(SYSS_RDONE)) != 0) {}
-    i2c->con &= ~LE32(CON_I2C_EN);
+    // timer providing the deadlines of the waits
+    am335x_dmtimer1_init();
 
-    // configure clock activity and idle mode
-    i2c->sysc = LE32(SYSC_IDLEMODE_NOIDLE | SYSC_CLKACTIVITY_BOTH);
+    reset_controller(ctrl);
+
+    // get size of the hardware fifos
+    uint32_t depth = (LE32(i2c->bufstat) & BUFSTAT_FIFODEPTH_MASK) >>
+                     BUFSTAT_FIFODEPTH_SHIFT;
+    ports[ctrl].fifo_size = 8 << depth;
+
+    // configure i2c bus speed and enable i2c contoller
+    am335x_i2c_set_bus_speed(ctrl, bus_speed);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_set_bus_speed(enum am335x_i2c_controllers ctrl,
+                             uint32_t bus_speed) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
 
-    // configure i2c bus speed
-    i2c->psc         = LE32(SYSTEM_CLOCK / INTERNAL_CLOCK) - 1;
-    uint32_t divider = (INTERNAL_CLOCK / 2) / bus_speed;
-    i2c->scll        = LE32(divider - 7);
-    i2c->sclh        = LE32(divider - 5);
+    const struct i2c_speed_mode* mode = 0;
+    for (unsigned i = 0; (i < ARRAY_SIZE(speed_modes)) && (mode == 0); i++)
+        if (bus_speed <= speed_modes[i].max_speed) mode = &speed_modes[i];
+    if ((bus_speed == 0) || (mode == 0)) return -1;
+    bool hs = mode->opmode == CON_OPMODE_HSI2C;
+
+    // search the prescaler giving the highest speed not above the requested
+    // one, the preferred internal clock of the mode is kept on equal speed
+    uint32_t psc      = 0;
+    uint32_t scll     = 0;
+    uint32_t sclh     = 0;
+    uint32_t achieved = 0;
+    for (uint32_t p = 0; p <= 0xff; p++) {
+        uint32_t iclk = SYSTEM_CLOCK / (p + 1);
+        uint32_t l, h, fs_l = 0, fs_h = 0;
+        uint32_t real = scl_timing(iclk, bus_speed, mode->low_pct, &l, &h);
+
+        // in high speed mode the master code is sent in fast mode
+        if (hs && (scl_timing(iclk, FS_SPEED_MAX, speed_modes[1].low_pct,
+                              &fs_l, &fs_h) == 0))
+            real = 0;
+        if (hs) {
+            l = (l << SCL_HS_SHIFT) | fs_l;
+            h = (h << SCL_HS_SHIFT) | fs_h;
+        }
 
-    //  enable i2c contoller
+        if ((real > achieved) ||
+            ((real == achieved) && (real != 0) &&
+             (abs((int)(iclk - mode->iclk)) <
+              abs((int)(SYSTEM_CLOCK / (psc + 1) - mode->iclk))))) {
+            psc      = p;
+            scll     = l;
+            sclh     = h;
+            achieved = real;
+        }
+    }
+    if (achieved == 0) return -1;
+
+    // the prescaler may only be changed while the controller is disabled
+    i2c->con &= ~LE32(CON_I2C_EN);
+    i2c->psc  = LE32(psc);
+    i2c->scll = LE32(scll);
+    i2c->sclh = LE32(sclh);
+    i2c->oa   = (i2c->oa & ~LE32(OA_MCODE_MASK)) |
+              LE32(HS_MASTER_CODE << OA_MCODE_SHIFT);
+    i2c->con = (i2c->con & ~LE32(CON_OPMODE_MASK)) | LE32(mode->opmode);
+
+    //  enable i2c contoller
     i2c->con |= LE32(CON_I2C_EN);
+
+    ports[ctrl].requested = bus_speed;
+    ports[ctrl].bus_speed = achieved;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t am335x_i2c_get_bus_speed(enum am335x_i2c_controllers ctrl) {
+    return ports[ctrl].bus_speed;
 }
 
 /* -------------------------------------------------------------------------- */
 
 int am335x_i2c_read(enum am335x_i2c_controllers ctrl, uint8_t chip_id,
                     uint8_t reg, uint8_t* data, uint16_t data_len) {
-    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+    return am335x_i2c_read_ext(ctrl, chip_id, reg, 1, data, data_len);
+}
 
-    // clear buffers and former pending status flags
-    i2c->buf |= LE32(BUF_RXFIFO_CLR | BUF_TXFIFO_CLR);
-    i2c->irqstatus = LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_BF);
+/* -------------------------------------------------------------------------- */
 
-    // poll bus busy condition
-    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_BB)) != 0)
-        ;
+int am335x_i2c_read_ext(enum am335x_i2c_controllers ctrl, uint8_t chip_id,
+                        uint32_t reg, uint32_t reg_size, uint8_t* data,
+                        uint16_t data_len) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
 
-    // set slave address (identification of the slave chip)
-    i2c->sa = LE32(chip_id);
+    if ((reg_size > 3) || (data_len == 0)) return AM335X_I2C_EINVAL;
 
-    // --- write command word if required
-    // define number of byte to transfer
-    i2c->cnt = LE32(1);
+    // wait until the bus is free
+    int status = wait_bus_free(ctrl);
+    if (status != 0) return status;
 
-    // start transfer as master & transmitter
-    i2c->con |= LE32(CON_MST | CON_TRX | CON_STT | CON_STP);
+    // clear buffers and former pending status flags
+    uint32_t threshold = setup_fifo(ctrl, reg_size);
+    i2c->irqstatus =
+        LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_BF | IRQSTATUS_RAW_ARDY);
 
-    // wait for sending data bytes
-    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_XRDY)) == 0) {}
-    i2c->data = LE32(reg);
+    // set slave address (identification of the slave chip)
+    i2c->sa = LE32(chip_id);
 
-    // wait until transfer complete and check if done correctly
-    if (wait_for_status(i2c, IRQSTATUS_RAW_BF) == 0) {
-        if ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_NACK)) != 0) {
-            return -1;
-        }
+    // --- write register address if required
+    if (reg_size > 0) {
+        // define number of byte to transfer
+        i2c->cnt = LE32(reg_size);
+
+        // start transfer as master & transmitter, without stop condition
+        i2c->con |= LE32(CON_MST | CON_TRX | CON_STT);
+        status = send_bytes(ctrl, threshold, reg, reg_size, 0, 0);
+
+        // wait until address sent and check if done correctly
+        if (status == 0)
+            status = wait_for_status(i2c, IRQSTATUS_RAW_ARDY,
+                                     transfer_timeout(ctrl, threshold));
+        if (status != 0) return end_transfer(ctrl, status);
+        i2c->irqstatus = LE32(IRQSTATUS_RAW_ARDY);
     }
 
     // --- read specified number of data bytes
     // indicate number of bytes to read
-    i2c->cnt = LE32(data_len);
+    threshold = setup_fifo(ctrl, data_len);
+    i2c->cnt  = LE32(data_len);
 
-    // initiate read data transfer
+    // initiate read data transfer with a (repeated) start condition
     i2c->con = (i2c->con & ~LE32(CON_TRX)) |
                LE32(CON_MST | CON_STT | CON_STP);
 
-    // wait until data received and read them
-    while (data_len > 0) {
-        while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_RRDY)) == 0) {}
-        *data++ = LE32(i2c->data);
-        data_len--;
-        i2c->irqstatus = LE32(IRQSTATUS_RAW_RRDY);
-    }
-
-    // acknowlegde all status information
-    i2c->irqstatus = i2c->irqstatus_raw;
+    // wait until data received and read them by chunks
+    status = receive_bytes(ctrl, threshold, data, data_len);
 
-    return 0;
+    return end_transfer(ctrl, status);
 }
 
 /* -------------------------------------------------------------------------- */
 
 int am335x_i2c_write(enum am335x_i2c_controllers ctrl, uint8_t chip_id,
                      uint8_t reg, const uint8_t* data, uint16_t data_len) {
+    return am335x_i2c_write_ext(ctrl, chip_id, reg, 1, data, data_len);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_write_ext(enum am335x_i2c_controllers ctrl, uint8_t chip_id,
+                         uint32_t reg, uint32_t reg_size, const uint8_t* data,
+                         uint16_t data_len) {
     volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
 
-    // clear buffers and former pending status flags
-    i2c->buf |= LE32(BUF_RXFIFO_CLR | BUF_TXFIFO_CLR);
-    i2c->irqstatus = LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_BF);
+    uint32_t len = reg_size + data_len;
+    if ((reg_size > 3) || (len == 0) || (len > 0xffff))
+        return AM335X_I2C_EINVAL;
+
+    // wait until the bus is free
+    int status = wait_bus_free(ctrl);
+    if (status != 0) return status;
 
-    // poll bus busy condition
-    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_BB)) != 0)
-        ;
+    // clear buffers and former pending status flags
+    uint32_t threshold = setup_fifo(ctrl, len);
+    i2c->irqstatus     = LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_BF);
 
     // set slave address (identification of the slave chip)
     i2c->sa = LE32(chip_id);
 
     // define number of byte to transfer
-    i2c->cnt = LE32(1 + data_len);
+    i2c->cnt = LE32(len);
 
     // start transfer as master & transmitter
     i2c->con |= LE32(CON_MST | CON_TRX | CON_STT | CON_STP);
 
-    // --- write command word
-    // wait for sending data bytes
-    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_XRDY)) == 0)
-        ;
-    i2c->data = LE32(reg);
-
-    // --- write specified number of data bytes
-    // wait until data received and read them
-    while (data_len > 0) {
-        // wait for sending data bytes
-        while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_XRDY)) == 0) {}
-        i2c->data      = LE32(*data++);
-        i2c->irqstatus = LE32(IRQSTATUS_RAW_XRDY);
-        data_len--;
-    }
+    // --- write register address followed by the data bytes
+    status = send_bytes(ctrl, threshold, reg, reg_size, data, data_len);
 
     // wait until transfer complete and check if done correctly
-    if (wait_for_status(i2c, IRQSTATUS_RAW_BF) == 0) {
-        if ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_NACK)) != 0) {
-            return -1;
-        }
+    if (status == 0)
+        status = wait_for_status(i2c, IRQSTATUS_RAW_BF,
+                                 transfer_timeout(ctrl, threshold));
+
+    return end_transfer(ctrl, status);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_transfer(enum am335x_i2c_controllers ctrl,
+                        struct am335x_i2c_msg* msgs, uint32_t n) {
+    volatile struct am335x_i2c_ctrl* i2c = i2c_ctrl[ctrl];
+
+    for (uint32_t i = 0; i < n; i++) {
+        msgs[i].status = AM335X_I2C_ECANCELED;
+        if (msgs[i].len == 0) return AM335X_I2C_EINVAL;
     }
+    if (n == 0) return 0;
 
-    // acknowlegde all status information
-    i2c->irqstatus = i2c->irqstatus_raw;
+    // wait until the bus is free
+    int status = wait_bus_free(ctrl);
+    if (status != 0) return status;
 
-    return 0;
+    // clear buffers and former pending status flags
+    uint32_t threshold = setup_fifo(ctrl, msgs[0].len);
+    i2c->irqstatus     = LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_AL |
+                          IRQSTATUS_RAW_BF | IRQSTATUS_RAW_ARDY);
+
+    uint32_t chip_id = ~0;
+    for (uint32_t i = 0; (i < n) && (status == 0); i++) {
+        struct am335x_i2c_msg* msg  = &msgs[i];
+        bool                   last = i == n - 1;
+
+        // only reprogram what differs from the previous message
+        if (msg->chip_id != chip_id) {
+            chip_id = msg->chip_id;
+            i2c->sa = LE32(chip_id);
+        }
+        if (fifo_threshold(ctrl, msg->len) != threshold)
+            threshold = setup_fifo(ctrl, msg->len);
+        i2c->cnt = LE32(msg->len);
+
+        // start the segment, with a repeated start condition after the
+        // first one and a stop condition after the last one
+        uint32_t con = LE32(i2c->con) & ~(CON_TRX | CON_STP);
+        con |= CON_MST | CON_STT | (msg->read ? 0 : CON_TRX);
+        if (last) con |= CON_STP;
+        i2c->con = LE32(con);
+
+        if (msg->read)
+            status = receive_bytes(ctrl, threshold, msg->buf, msg->len);
+        else
+            status = send_bytes(ctrl, threshold, 0, 0, msg->buf, msg->len);
+
+        // wait until the segment is complete and check if done correctly
+        if (status == 0)
+            status = wait_for_status(
+                i2c, last ? IRQSTATUS_RAW_BF : IRQSTATUS_RAW_ARDY,
+                transfer_timeout(ctrl, threshold));
+        i2c->irqstatus = LE32(IRQSTATUS_RAW_ARDY);
+        msg->status    = status;
+    }
+
+    // release the bus if the transfer has been aborted
+    return end_transfer(ctrl, status);
 }
 
 /* -------------------------------------------------------------------------- */
-__attribute__((optimize(0))) bool am335x_i2c_probe(
-    enum am335x_i2c_controllers ctrl, uint8_t chip_id) {
+bool am335x_i2c_probe(enum am335x_i2c_controllers ctrl, uint8_t chip_id) {
     volatile struct am335x_i2c_ctrl* i2c   = i2c_ctrl[ctrl];
     bool                             found = false;
 
+    // the chips of a scanned bus are already known
+    if (ports[ctrl].scanned && (chip_id >= SCAN_FIRST) &&
+        (chip_id <= SCAN_LAST))
+        return am335x_i2c_device_present(&ports[ctrl].devices, chip_id);
+
+    // wait until the bus is free
+    if (wait_bus_free(ctrl) != 0) return false;
+
     // clear former pending status flags
+    (void)setup_fifo(ctrl, 1);
     i2c->irqstatus = LE32(IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_BF);
 
-    //  poll until bus busy condition is false
-    while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_BB)) != 0) {}
-
     // set slave address (identification of the slave chip)
     i2c->sa = LE32(chip_id);
 
@@ -363,20 +1213,160 @@ __attribute__((optimize(0))) bool am335x_i2c_probe(
     i2c->con = (i2c->con & ~LE32(CON_TRX)) | LE32(CON_MST | CON_STT | CON_STP);
 
     // wait until transfer complete and check chip presence
-    // if (wait_for_status(i2c, IRQSTATUS_RAW_BF) == 0) {
-    wait_for_status(i2c, IRQSTATUS_RAW_BF);
-    found = (i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_NACK)) == 0;
-    //}
+    int status =
+        wait_for_status(i2c, IRQSTATUS_RAW_BF, transfer_timeout(ctrl, 1));
+    found = status == 0;
 
     // if device exists, then read dummy data byte and clear rx fifo
     if (found) {
-        while ((i2c->irqstatus_raw & LE32(IRQSTATUS_RAW_RRDY)) == 0) {}
+        status = wait_for_status(i2c, IRQSTATUS_RAW_RRDY,
+                                 transfer_timeout(ctrl, 0));
         uint32_t data = LE32(i2c->data);
         (void)data;
     }
 
-    // acknowlegde all status information
-    i2c->irqstatus = i2c->irqstatus_raw;
+    (void)end_transfer(ctrl, status);
 
     return found;
 }
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_scan(const enum am335x_i2c_controllers* ctrls, uint32_t nb,
+                    struct am335x_i2c_devices* devices) {
+    // start the scan of all buses, each one probes its next address
+    // from the completion handler of the previous probe
+    for (uint32_t i = 0; i < nb; i++) {
+        struct i2c_port* port = &ports[ctrls[i]];
+
+        memset(&port->devices, 0, sizeof(port->devices));
+        port->scanned     = false;
+        port->scan_status = 0;
+        port->scan        = (struct am335x_i2c_request){
+            .chip_id  = SCAN_FIRST,
+            .read     = true,
+            .data     = &port->scan_data,
+            .data_len = 1,
+            .routine  = scan_done,
+        };
+        port->scan_limit = deadline(transfer_timeout(ctrls[i], 1));
+        am335x_i2c_submit(ctrls[i], &port->scan);
+    }
+
+    // wait until all buses have been scanned, a probe exceeding its
+    // deadline is aborted
+    bool busy = true;
+    while (busy) {
+        busy = false;
+        for (uint32_t i = 0; i < nb; i++) {
+            struct i2c_port* port = &ports[ctrls[i]];
+
+            port_lock(ctrls[i]);
+            if ((port->head == &port->scan) && expired(port->scan_limit))
+                abort_request(ctrls[i], AM335X_I2C_ETIMEOUT);
+            if (!port->scan.done) busy = true;
+            port_unlock(ctrls[i]);
+        }
+    }
+
+    int status = 0;
+    for (uint32_t i = 0; i < nb; i++) {
+        struct i2c_port* port = &ports[ctrls[i]];
+
+        port->scanned = true;
+        if (devices != 0) devices[i] = port->devices;
+        if (status == 0) status = port->scan_status;
+    }
+
+    return status;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_i2c_scan_invalidate(enum am335x_i2c_controllers ctrl) {
+    ports[ctrl].scanned = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_submit(enum am335x_i2c_controllers ctrl,
+                      struct am335x_i2c_request* req) {
+    struct i2c_port* port = &ports[ctrl];
+
+    uint32_t len = req->reg_size + (req->read ? 0 : req->data_len);
+    if ((req->reg_size > 3) || (req->read && (req->data_len == 0)) ||
+        (len == 0) || (len > 0xffff))
+        return AM335X_I2C_EINVAL;
+
+    if (req->dma && !port->dma) dma_init(ctrl);
+
+    port_lock(ctrl);
+    queue_request(ctrl, req);
+    port_unlock(ctrl);
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_i2c_interrupt_handler(enum am335x_i2c_controllers ctrl) {
+    volatile struct am335x_i2c_ctrl* i2c  = i2c_ctrl[ctrl];
+    struct i2c_port*                 port = &ports[ctrl];
+    struct am335x_i2c_request*       req  = port->head;
+
+    uint32_t status = LE32(i2c->irqstatus) & (ASYNC_IRQS | IRQSTATUS_RAW_BF);
+    if (req == 0) {
+        i2c->irqstatus = LE32(status);
+        return;
+    }
+
+    // bus released after an aborted transfer: drop its late status (ARDY)
+    // and complete the request, the next one is started on a free bus
+    if ((port->wait & WAIT_STOP) != 0) {
+        if ((status & IRQSTATUS_RAW_BF) == 0) return;
+        i2c->irqenable_clr = LE32(IRQSTATUS_RAW_BF);
+        i2c->irqstatus     = LE32(ASYNC_IRQS | IRQSTATUS_RAW_BF);
+        complete_request(ctrl, port->error);
+        return;
+    }
+
+    // not acknowledged or arbitration lost: abort the transaction, the
+    // request is completed once the bus is free
+    if ((status & (IRQSTATUS_RAW_NACK | IRQSTATUS_RAW_AL)) != 0) {
+        if ((status & IRQSTATUS_RAW_NACK) != 0) i2c->con |= LE32(CON_STP);
+        i2c->irqstatus = LE32(status);
+        fail_request(ctrl, bus_error(status));
+        return;
+    }
+
+    // send the register address followed by the data to write
+    if ((status & TX_IRQS) != 0) {
+        uint32_t len = req->reg_size + (req->read ? 0 : req->data_len);
+        uint32_t nb  = tx_room(i2c, status, port->threshold);
+        if (nb > len - port->index) nb = len - port->index;
+        while (nb-- > 0) i2c->data = LE32(request_byte(req, port->index++));
+        i2c->irqstatus = LE32(status & TX_IRQS);
+    }
+
+    // store the received data
+    if ((status & RX_IRQS) != 0) {
+        uint32_t nb = rx_level(i2c, status, port->threshold);
+        while (nb-- > 0) {
+            uint8_t c = LE32(i2c->data);
+            if (port->index < req->data_len) req->data[port->index++] = c;
+        }
+        i2c->irqstatus = LE32(status & RX_IRQS);
+    }
+
+    // end of the transfer: read the data or complete the request once
+    // the dma has delivered them
+    if ((status & IRQSTATUS_RAW_ARDY) != 0) {
+        i2c->irqstatus = LE32(IRQSTATUS_RAW_ARDY);
+        if (req->read && (port->phase == PHASE_REG)) {
+            start_data_phase(ctrl);
+        } else {
+            port->wait &= ~WAIT_BUS;
+            if (port->wait == 0) complete_request(ctrl, 0);
+        }
+    }
+}
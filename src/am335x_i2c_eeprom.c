@@ -0,0 +1,155 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x I2C EEPROM access (24xx family)
+ *
+ * Purpose: This module implements the page splitting of the writes and
+ *          the acknowledge polling of the write cycles. The polling uses
+ *          the probe transaction (chip address followed by a one byte
+ *          read), which the device does not acknowledge while busy.
+ */
+
+#include "am335x_i2c_eeprom.h"
+#include "am335x_dmtimer1.h"
+
+// maximum number of bytes of an i2c transfer
+#define MAX_TRANSFER_LEN 0xffff
+
+/* --------------------------------------------------------------------------
+ * implementation of local methods
+ * -------------------------------------------------------------------------- */
+
+/**
+ * method to get the chip address of the block holding a memory address
+ */
+static inline uint8_t chip_of(const struct am335x_i2c_eeprom* eeprom,
+                              uint32_t addr) {
+    return eeprom->chip_id | (addr >> (8 * eeprom->addr_size));
+}
+
+/**
+ * method to get the address of a byte within its block
+ */
+static inline uint32_t offset_of(const struct am335x_i2c_eeprom* eeprom,
+                                 uint32_t addr) {
+    return addr & ((1u << (8 * eeprom->addr_size)) - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to wait for the end of a write cycle: the device is probed until
+ * it acknowledges its address again
+ *
+ *@return int status, 0=ready, error code otherwise
+ */
+static int wait_ready(const struct am335x_i2c_eeprom* eeprom, uint8_t chip) {
+    uint32_t timeout = eeprom->write_time *
+                       (am335x_dmtimer1_get_frequency() / 1000000);
+    uint32_t start = am335x_dmtimer1_get_counter();
+    while (1) {
+        uint8_t dummy;
+        int     status =
+            am335x_i2c_read_ext(eeprom->ctrl, chip, 0, 0, &dummy, 1);
+        if (status != AM335X_I2C_ENACK) return status;
+        if (am335x_dmtimer1_get_counter() - start > timeout)
+            return AM335X_I2C_ETIMEOUT;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+int am335x_i2c_eeprom_init(struct am335x_i2c_eeprom* eeprom,
+                           enum am335x_i2c_controllers ctrl, uint8_t chip_id,
+                           uint32_t addr_size, uint32_t page_size,
+                           uint32_t size, uint32_t write_time) {
+    if ((addr_size < 1) || (addr_size > 2) || (page_size == 0) ||
+        ((page_size & (page_size - 1)) != 0) || (size < page_size) ||
+        (size > (1u << (8 * addr_size + 3))))
+        return AM335X_I2C_EINVAL;
+
+    eeprom->ctrl       = ctrl;
+    eeprom->chip_id    = chip_id;
+    eeprom->addr_size  = addr_size;
+    eeprom->page_size  = page_size;
+    eeprom->size       = size;
+    eeprom->write_time = write_time;
+
+    am335x_dmtimer1_init();
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_eeprom_read(const struct am335x_i2c_eeprom* eeprom,
+                           uint32_t addr, void* data, uint32_t len) {
+    if ((addr > eeprom->size) || (len > eeprom->size - addr))
+        return AM335X_I2C_EINVAL;
+
+    // a sequential read wraps around at the end of the block addressed by
+    // the chip address, the reads are split on these boundaries
+    uint8_t* dst   = data;
+    uint32_t block = 1u << (8 * eeprom->addr_size);
+    while (len > 0) {
+        uint32_t nb = block - offset_of(eeprom, addr);
+        if (nb > MAX_TRANSFER_LEN) nb = MAX_TRANSFER_LEN;
+        if (nb > len) nb = len;
+
+        int status = am335x_i2c_read_ext(
+            eeprom->ctrl, chip_of(eeprom, addr), offset_of(eeprom, addr),
+            eeprom->addr_size, dst, nb);
+        if (status != 0) return status;
+
+        addr += nb;
+        dst += nb;
+        len -= nb;
+    }
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_eeprom_write(const struct am335x_i2c_eeprom* eeprom,
+                            uint32_t addr, const void* data, uint32_t len) {
+    if ((addr > eeprom->size) || (len > eeprom->size - addr))
+        return AM335X_I2C_EINVAL;
+
+    // a page write wraps around at the end of the page, the writes are
+    // split on page boundaries
+    const uint8_t* src = data;
+    while (len > 0) {
+        uint32_t nb = eeprom->page_size - (addr & (eeprom->page_size - 1));
+        if (nb > len) nb = len;
+
+        uint8_t chip   = chip_of(eeprom, addr);
+        int     status = am335x_i2c_write_ext(eeprom->ctrl, chip,
+                                          offset_of(eeprom, addr),
+                                          eeprom->addr_size, src, nb);
+        if (status == 0) status = wait_ready(eeprom, chip);
+        if (status != 0) return status;
+
+        addr += nb;
+        src += nb;
+        len -= nb;
+    }
+
+    return 0;
+}
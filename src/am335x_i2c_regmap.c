@@ -0,0 +1,212 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: AM335x I2C device register map cache
+ *
+ * Purpose: This module implements the register map cache. The state of
+ *          each cached register is kept in bitmaps (valid, dirty and
+ *          volatile), indexed by the register offset from the map base.
+ */
+
+#include <string.h>
+
+#include "am335x_i2c_regmap.h"
+
+/* --------------------------------------------------------------------------
+ * implementation of local methods
+ * -------------------------------------------------------------------------- */
+
+static inline bool test_bit(const uint32_t* bitmap, uint32_t i) {
+    return (bitmap[i / 32] & (1u << (i % 32))) != 0;
+}
+
+static inline void set_bit(uint32_t* bitmap, uint32_t i) {
+    bitmap[i / 32] |= 1u << (i % 32);
+}
+
+static inline void clear_bit(uint32_t* bitmap, uint32_t i) {
+    bitmap[i / 32] &= ~(1u << (i % 32));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to check if a register is held by the cache
+ *
+ *@return true if cached, its offset from the map base is stored in index
+ */
+static bool cached(const struct am335x_i2c_regmap* map, uint32_t reg,
+                   uint32_t* index) {
+    if ((reg < map->base) || (reg - map->base >= map->nb_regs)) return false;
+    *index = reg - map->base;
+    return !test_bit(map->volatile_regs, *index);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to check if a register can be written together with the dirty
+ * registers around it: its cached value is rewritten unchanged
+ */
+static bool clean_filler(const struct am335x_i2c_regmap* map, uint32_t i) {
+    return test_bit(map->valid, i) && !test_bit(map->volatile_regs, i);
+}
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+int am335x_i2c_regmap_init(struct am335x_i2c_regmap* map,
+                           enum am335x_i2c_controllers ctrl, uint8_t chip_id,
+                           uint32_t reg_size, uint32_t base, uint32_t nb_regs,
+                           bool write_back) {
+    if ((reg_size < 1) || (reg_size > 3) ||
+        (nb_regs > AM335X_I2C_REGMAP_SIZE))
+        return AM335X_I2C_EINVAL;
+
+    memset(map, 0, sizeof(*map));
+    map->ctrl       = ctrl;
+    map->chip_id    = chip_id;
+    map->reg_size   = reg_size;
+    map->base       = base;
+    map->nb_regs    = nb_regs;
+    map->write_back = write_back;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_i2c_regmap_set_volatile(struct am335x_i2c_regmap* map,
+                                    uint32_t reg, uint32_t nb) {
+    for (; nb > 0; reg++, nb--) {
+        if ((reg < map->base) || (reg - map->base >= map->nb_regs)) continue;
+        uint32_t i = reg - map->base;
+        set_bit(map->volatile_regs, i);
+        clear_bit(map->valid, i);
+        clear_bit(map->dirty, i);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_regmap_read(struct am335x_i2c_regmap* map, uint32_t reg,
+                           uint8_t* value) {
+    uint32_t i;
+    if (!cached(map, reg, &i))
+        return am335x_i2c_read_ext(map->ctrl, map->chip_id, reg,
+                                   map->reg_size, value, 1);
+
+    if (!test_bit(map->valid, i)) {
+        int status = am335x_i2c_read_ext(map->ctrl, map->chip_id, reg,
+                                         map->reg_size, &map->values[i], 1);
+        if (status != 0) return status;
+        set_bit(map->valid, i);
+    }
+    *value = map->values[i];
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_regmap_write(struct am335x_i2c_regmap* map, uint32_t reg,
+                            uint8_t value) {
+    uint32_t i;
+    if (!cached(map, reg, &i))
+        return am335x_i2c_write_ext(map->ctrl, map->chip_id, reg,
+                                    map->reg_size, &value, 1);
+
+    if (test_bit(map->valid, i) && (map->values[i] == value)) return 0;
+
+    map->values[i] = value;
+    set_bit(map->valid, i);
+    if (map->write_back) {
+        set_bit(map->dirty, i);
+        return 0;
+    }
+
+    int status = am335x_i2c_write_ext(map->ctrl, map->chip_id, reg,
+                                      map->reg_size, &value, 1);
+    if (status != 0) clear_bit(map->valid, i);  // device state unknown
+
+    return status;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_regmap_update_bits(struct am335x_i2c_regmap* map,
+                                  uint32_t reg, uint8_t mask, uint8_t value) {
+    uint8_t old;
+    int     status = am335x_i2c_regmap_read(map, reg, &old);
+    if (status != 0) return status;
+
+    uint8_t new = (old & ~mask) | (value & mask);
+    uint32_t i;
+    if ((new == old) && cached(map, reg, &i)) return 0;
+
+    return am335x_i2c_regmap_write(map, reg, new);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_i2c_regmap_sync(struct am335x_i2c_regmap* map) {
+    // a gap of clean registers shorter than the header of a new transfer
+    // (start, chip and register address) is cheaper to rewrite
+    uint32_t max_gap = 2 + map->reg_size;
+    int      status  = 0;
+
+    uint32_t i = 0;
+    while (i < map->nb_regs) {
+        if (!test_bit(map->dirty, i)) {
+            i++;
+            continue;
+        }
+
+        // extend the burst over the following dirty registers and the
+        // short gaps of clean ones
+        uint32_t first = i;
+        uint32_t last  = i;
+        for (uint32_t j = i + 1; j < map->nb_regs; j++) {
+            if (test_bit(map->dirty, j)) {
+                last = j;
+            } else if ((j - last > max_gap) || !clean_filler(map, j)) {
+                break;
+            }
+        }
+
+        uint32_t len = last - first + 1;
+        int      err = am335x_i2c_write_ext(map->ctrl, map->chip_id,
+                                       map->base + first, map->reg_size,
+                                       &map->values[first], len);
+        if (err == 0) {
+            for (uint32_t j = first; j <= last; j++) clear_bit(map->dirty, j);
+        } else {
+            status = err;
+        }
+        i = last + 1;
+    }
+
+    return status;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_i2c_regmap_invalidate(struct am335x_i2c_regmap* map) {
+    memset(map->valid, 0, sizeof(map->valid));
+    memset(map->dirty, 0, sizeof(map->dirty));
+}
@@ -224,6 +224,21 @@ static const struct uart_pad_ctrl {
             .rxd = {1, 10, 0 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
             .txd = {1, 11, 0 | PAD_CONTROL_PULLUP | PAD_CONTROL_SLEWCTRL},
         },
+    [1] =
+        {
+            .rxd = {0, 14, 0 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .txd = {0, 15, 0 | PAD_CONTROL_PULLDOWN | PAD_CONTROL_SLEWCTRL},
+        },
+    [2] =
+        {
+            .rxd = {0, 2, 1 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .txd = {0, 3, 1 | PAD_CONTROL_PULLDOWN | PAD_CONTROL_SLEWCTRL},
+        },
+    [3] =
+        {
+            .rxd = {0, 6, 1 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .txd = {0, 7, 1 | PAD_CONTROL_PULLDOWN | PAD_CONTROL_SLEWCTRL},
+        },
     [4] =
         {
             .rxd = {0, 30, 6 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
@@ -236,6 +251,33 @@ static const struct uart_pad_ctrl {
         },
 };
 
+// uart flow control pad control (only uarts with exposed cts/rts pins)
+static const struct uart_flow_pad_ctrl {
+    pad_t ctsn;
+    pad_t rtsn;
+} uart_flow_pad[6] = {
+    [0] =
+        {
+            .ctsn = {1, 8, 0 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .rtsn = {1, 9, 0 | PAD_CONTROL_PULLUP | PAD_CONTROL_SLEWCTRL},
+        },
+    [1] =
+        {
+            .ctsn = {0, 12, 0 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .rtsn = {0, 13, 0 | PAD_CONTROL_PULLUP | PAD_CONTROL_SLEWCTRL},
+        },
+    [4] =
+        {
+            .ctsn = {0, 8, 6 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .rtsn = {0, 9, 6 | PAD_CONTROL_PULLUP | PAD_CONTROL_SLEWCTRL},
+        },
+    [5] =
+        {
+            .ctsn = {0, 10, 6 | PAD_CONTROL_RXACTIVE | PAD_CONTROL_PULLUP},
+            .rtsn = {0, 11, 6 | PAD_CONTROL_PULLUP | PAD_CONTROL_SLEWCTRL},
+        },
+};
+
 // i2c pad control
 static const struct i2c_pad_ctrl {
     pad_t sda;
@@ -425,6 +467,17 @@ void am335x_mux_setup_uart_pins(enum am335x_mux_uart_modules module)
 
 /* -------------------------------------------------------------------------- */
 
+int am335x_mux_setup_uart_flow_pins(enum am335x_mux_uart_modules module)
+{
+    const struct uart_flow_pad_ctrl* pad = &uart_flow_pad[module];
+    if (pad->ctsn.mode == 0) return -1;
+    pad_cfg(&pad->ctsn);
+    pad_cfg(&pad->rtsn);
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 void am335x_mux_setup_i2c_pins(enum am335x_mux_i2c_modules module)
 {
     const struct i2c_pad_ctrl* pad = &i2c_pad[module];
@@ -27,10 +27,13 @@
  * Date:    17.03.2019
  */
 
+#include <string.h>
+
 #include "support.h"
 #include "am335x_spi.h"
 
 #include "am335x_clock.h"
+#include "am335x_edma.h"
 #include "am335x_mux.h"
 
 // define am335x spi channel registers
@@ -42,6 +45,19 @@ struct am335x_spi_channel {
     uint32_t rx;      // 13c + (n * 0x14)
 };
 
+// SPI CHxCONF channel configuration register bit definition
+#define CHCONF_FFER     (1 << 28)
+#define CHCONF_FFEW     (1 << 27)
+#define CHCONF_FORCE    (1 << 20)
+#define CHCONF_DMAR     (1 << 15)
+#define CHCONF_DMAW     (1 << 14)
+#define CHCONF_TRM_MASK (0x3 << 12)
+#define CHCONF_TRM_TXRX (0x0 << 12)
+#define CHCONF_TRM_RX   (0x1 << 12)
+#define CHCONF_TRM_TX   (0x2 << 12)
+#define CHCONF_WL_MASK  (0x1f << 7)
+#define CHCONF_WL_SHIFT (7)
+
 // SPI CHxSTAT channel status register bit definition
 #define CHSTAT_RXFFF (1 << 6)
 #define CHSTAT_RXFFE (1 << 5)
@@ -85,9 +101,23 @@ struct am335x_spi_ctrl {
 #define SYSCONFIG_SRST                (1 << 1)
 #define SYSCONFIG_AUTOIDLE            (1 << 0)
 
+// SPI MODULCTRL register bit definition
+#define MODULCTRL_MOA                 (1 << 7)
+
 // SPI SYSTATUS bit definition
 #define SYSSTATUS_RDONE               (1 << 0)
 
+// SPI XFERLEVEL register bit definition (levels in bytes)
+#define XFERLEVEL_WCNT_MASK           (0xffff << 16)
+#define XFERLEVEL_WCNT_SHIFT          (16)
+#define XFERLEVEL_AFL_MASK            (0xff << 8)
+#define XFERLEVEL_AFL_SHIFT           (8)
+#define XFERLEVEL_AEL_MASK            (0xff << 0)
+#define XFERLEVEL_AEL_SHIFT           (0)
+
+// size of the fifo buffer, shared by tx and rx when both are enabled
+#define FIFO_SIZE                     64
+
 // spi clocking values
 #define SYSTEM_CLOCK                  48000000
 
@@ -109,6 +139,290 @@ static const enum am335x_mux_spi_modules spi2mux[] = {
     AM335X_MUX_SPI1,
 };
 
+// table to convert spi interface and channel to dma channels
+static const struct spi_dma_events {
+    uint32_t tx;  // tx dma channel
+    uint32_t rx;  // rx dma channel
+} spi2dma[][2] = {
+    {{16, 17}, {18, 19}},
+    {{42, 43}, {44, 45}},
+};
+
+// dma transfer queue of each controller
+static struct spi_port {
+    struct am335x_spi_dma_request* head;  // request in progress
+    struct am335x_spi_dma_request* tail;  // last queued request
+    bool                           dma;   // dma channels attached
+} ports[2];
+
+// dma source of the words sent without tx buffer and sink of the words
+// received without rx buffer
+static uint32_t dma_zero;
+static uint32_t dma_sink;
+
+/* --------------------------------------------------------------------------
+ * implementation of local methods
+ * -------------------------------------------------------------------------- */
+
+/**
+ * method to get the number of bytes taken by a word in the fifos and in
+ * the data buffers (1, 2 or 4)
+ */
+static uint32_t word_size(volatile struct am335x_spi_channel* chan) {
+    uint32_t word_len =
+        ((LE32(chan->chconf) & CHCONF_WL_MASK) >> CHCONF_WL_SHIFT) + 1;
+    return word_len <= 8 ? 1 : word_len <= 16 ? 2 : 4;
+}
+
+/**
+ * method to get the number of words held by a fifo. the buffer is split
+ * between tx and rx in full duplex transfers.
+ */
+static uint32_t fifo_depth(volatile struct am335x_spi_channel* chan,
+                           bool shared) {
+    return FIFO_SIZE / (shared ? 2 : 1) / word_size(chan);
+}
+
+/**
+ * method to program the fifo levels and the word counter of a transfer,
+ * the almost empty and almost full events (and dma requests) are raised
+ * every level bytes. the word counter lets the channel signal the end of
+ * the transfer (EOT), it is disabled above 65535 words.
+ */
+static void setup_fifo(volatile struct am335x_spi_ctrl* spi, uint32_t level,
+                       size_t len) {
+    uint32_t wcnt = len <= 0xffff ? len : 0;
+    spi->xferlevel = LE32((wcnt << XFERLEVEL_WCNT_SHIFT) |
+                          ((level - 1) << XFERLEVEL_AFL_SHIFT) |
+                          ((level - 1) << XFERLEVEL_AEL_SHIFT));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to stream words back to back through the fifos of an enabled
+ * channel. in full duplex the tx fifo is kept filled as long as the rx fifo
+ * can hold the answers. in transmit only mode the method returns once the
+ * last word has been shifted out.
+ *
+ *@param len number of words, a multiple of pack
+ *@param depth fifo depth in words
+ *@param size size of the words in bytes
+ *@param pack number of words per register access (multiword access)
+ */
+static void stream_words(volatile struct am335x_spi_channel* chan,
+                         const uint8_t* tx, uint8_t* rx, size_t len,
+                         uint32_t depth, uint32_t size, uint32_t pack) {
+    uint32_t step     = size * pack;  // bytes per register access
+    size_t   sent     = tx != 0 ? 0 : len;
+    size_t   received = rx != 0 ? 0 : len;
+    while ((sent < len) || (received < len)) {
+        while ((sent < len) && ((rx == 0) || (sent - received < depth)) &&
+               ((chan->chstat & LE32(CHSTAT_TXFFF)) == 0)) {
+            uint32_t data = 0;
+            memcpy(&data, tx, step);
+            chan->tx = LE32(data);
+            tx += step;
+            sent += pack;
+        }
+        while ((received < len) && ((tx == 0) || (received < sent)) &&
+               ((chan->chstat & LE32(CHSTAT_RXFFE)) == 0)) {
+            uint32_t data = LE32(chan->rx);
+            memcpy(rx, &data, step);
+            rx += step;
+            received += pack;
+        }
+    }
+
+    if (rx == 0) {
+        uint32_t done = CHSTAT_TXFFE | CHSTAT_EOT;
+        while ((chan->chstat & LE32(done)) != LE32(done)) {}
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to protect the dma transfer queue against the dma interrupt
+ */
+static void port_lock(enum am335x_spi_controllers ctrl) {
+    am335x_edma_mask_interrupt(spi2dma[ctrl][AM335X_CHAN0].rx);
+    am335x_edma_mask_interrupt(spi2dma[ctrl][AM335X_CHAN1].rx);
+}
+
+static void port_unlock(enum am335x_spi_controllers ctrl) {
+    am335x_edma_unmask_interrupt(spi2dma[ctrl][AM335X_CHAN0].rx);
+    am335x_edma_unmask_interrupt(spi2dma[ctrl][AM335X_CHAN1].rx);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to start the request at the head of the queue: each word is moved
+ * by its own dma event, through the fifos. the completion of the rx
+ * transfer signals the end of the request.
+ */
+static void dma_start(enum am335x_spi_controllers ctrl) {
+    volatile struct am335x_spi_ctrl*    spi  = spi_ctrl[ctrl];
+    struct am335x_spi_dma_request*      req  = ports[ctrl].head;
+    volatile struct am335x_spi_channel* chan = &spi->channel[req->channel];
+    const struct spi_dma_events*        dma  = &spi2dma[ctrl][req->channel];
+
+    // make the data visible to the dma controller
+    if (req->tx != 0) arm_flush_cache((uint32_t*)req->tx, req->len);
+    if (req->rx != 0) arm_flush_cache((uint32_t*)req->rx, req->len);
+
+    uint32_t size = word_size(chan);
+
+    struct am335x_edma_transfer tx = {
+        .src       = req->tx != 0 ? req->tx : (uint8_t*)&dma_zero,
+        .dst       = &chan->tx,
+        .acnt      = size,
+        .bcnt      = req->len / size,
+        .src_bidx  = req->tx != 0 ? size : 0,
+        .dst_bidx  = 0,
+        .link      = AM335X_EDMA_NO_LINK,
+        .tcc       = dma->tx,
+        .interrupt = false,
+    };
+    struct am335x_edma_transfer rx = {
+        .src       = &chan->rx,
+        .dst       = req->rx != 0 ? req->rx : (uint8_t*)&dma_sink,
+        .acnt      = size,
+        .bcnt      = req->len / size,
+        .src_bidx  = 0,
+        .dst_bidx  = req->rx != 0 ? size : 0,
+        .link      = AM335X_EDMA_NO_LINK,
+        .tcc       = dma->rx,
+        .interrupt = true,
+    };
+    am335x_edma_setup(dma->tx, &tx);
+    am335x_edma_setup(dma->rx, &rx);
+    am335x_edma_enable(dma->rx);
+    am335x_edma_enable(dma->tx);
+
+    // the first tx request is raised when the channel is enabled
+    setup_fifo(spi, size, req->len / size);
+    chan->chconf |= LE32(CHCONF_FFER | CHCONF_FFEW | CHCONF_DMAR |
+                         CHCONF_DMAW | CHCONF_FORCE);
+    chan->chctrl |= LE32(CHCTRL_EN);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * dma completion handler, the last word of the request in progress has
+ * been received: the channel is released and the next request started
+ */
+static void dma_rx_done(uint32_t channel, void* param) {
+    struct spi_port*               port = param;
+    enum am335x_spi_controllers    ctrl = port - ports;
+    struct am335x_spi_dma_request* req  = port->head;
+    (void)channel;
+
+    if (req == 0) return;
+
+    volatile struct am335x_spi_ctrl*    spi  = spi_ctrl[ctrl];
+    volatile struct am335x_spi_channel* chan = &spi->channel[req->channel];
+    const struct spi_dma_events*        dma  = &spi2dma[ctrl][req->channel];
+
+    chan->chctrl &= ~LE32(CHCTRL_EN);
+    chan->chconf &= ~LE32(CHCONF_FFER | CHCONF_FFEW | CHCONF_DMAR |
+                          CHCONF_DMAW | (req->hold ? 0 : CHCONF_FORCE));
+    spi->xferlevel = 0;
+    am335x_edma_disable(dma->tx);
+    am335x_edma_disable(dma->rx);
+    if (req->rx != 0) arm_dcache_invalidate((uint32_t*)req->rx, req->len);
+
+    port->head = req->next;
+    if (port->head != 0)
+        dma_start(ctrl);
+    else
+        port->tail = 0;
+
+    req->done = true;
+    if (req->routine != 0) req->routine(ctrl, req, req->param);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to attach the dma channels of a controller
+ */
+static void dma_init(enum am335x_spi_controllers ctrl) {
+    am335x_edma_init();
+    for (int i = AM335X_CHAN0; i <= AM335X_CHAN1; i++) {
+        const struct spi_dma_events* dma = &spi2dma[ctrl][i];
+        am335x_edma_clear(dma->tx);
+        am335x_edma_clear(dma->rx);
+        am335x_edma_attach(dma->rx, dma_rx_done, &ports[ctrl]);
+    }
+    arm_flush_cache((uint32_t*)&dma_zero, sizeof(dma_zero));
+    ports[ctrl].dma = true;
+}
+
+/**
+ * method to transfer words of the specified size, the buffers may be null
+ * for transmit only or receive only transfers
+ *
+ *@return int status, 0=success, -1=word size not matching the channel
+ */
+static int transfer(enum am335x_spi_controllers ctrl,
+                    enum am335x_spi_channels channel, const uint8_t* tx,
+                    uint8_t* rx, size_t len, uint32_t size) {
+    volatile struct am335x_spi_ctrl*    spi  = spi_ctrl[ctrl];
+    volatile struct am335x_spi_channel* chan = &spi->channel[channel];
+
+    if (((tx == 0) && (rx == 0)) || (word_size(chan) != size)) return -1;
+
+    // select the transfer mode, the unused direction is neither clocked
+    // into a fifo nor read back and the other one gets the whole buffer
+    uint32_t mode = CHCONF_TRM_TXRX | CHCONF_FFEW | CHCONF_FFER;
+    if (rx == 0) mode = CHCONF_TRM_TX | CHCONF_FFEW;
+    if (tx == 0) mode = CHCONF_TRM_RX | CHCONF_FFER;
+    uint32_t depth = fifo_depth(chan, (tx != 0) && (rx != 0));
+
+    // the channel owns the fifo for the duration of the transfer, it is
+    // configured while the channel is disabled
+    chan->chconf = (chan->chconf & ~LE32(CHCONF_TRM_MASK)) |
+                   LE32(mode | CHCONF_FORCE);
+
+    // the word counter stops a receive only transfer after its last word,
+    // longer transfers are split while the chip select is kept active.
+    // words of 8 and 16 bits are packed by 32-bit register accesses
+    // (multiword access), the remaining words are moved one by one.
+    while (len > 0) {
+        uint32_t pack = 4 / size;
+        if (len < pack) pack = 1;
+        size_t nb = len > 0xffff ? 0xffff : len;
+        nb -= nb % pack;
+
+        if (pack > 1)
+            spi->modulctrl |= LE32(MODULCTRL_MOA);
+        else
+            spi->modulctrl &= ~LE32(MODULCTRL_MOA);
+        setup_fifo(spi, depth / 2 * size, nb);
+
+        chan->chctrl |= LE32(CHCTRL_EN);
+        stream_words(chan, tx, rx, nb, depth, size, pack);
+        chan->chctrl &= ~LE32(CHCTRL_EN);
+
+        if (tx != 0) tx += nb * size;
+        if (rx != 0) rx += nb * size;
+        len -= nb;
+    }
+
+    // release the fifo and restore the full duplex mode
+    spi->modulctrl &= ~LE32(MODULCTRL_MOA);
+    chan->chconf &= ~LE32(CHCONF_TRM_MASK | CHCONF_FFER | CHCONF_FFEW |
+                          CHCONF_FORCE);
+    spi->xferlevel = 0;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /* --------------------------------------------------------------------------
  * implementation of the public methods
  * -------------------------------------------------------------------------- */
@@ -172,7 +486,7 @@ void am335x_spi_init(enum am335x_spi_controllers ctrl,
         }
     }
 
-    // configure channel (tx & rx fifo disabled)
+    // configure channel (fifos enabled by the transfers)
     chan->chconf = LE32(
         (clkg << 29)             // clock granularity
         | (3 << 25)              // chip select time control 2.5 cycles
@@ -201,27 +515,63 @@ void am335x_spi_init(enum am335x_spi_controllers ctrl,
 int am335x_spi_xfer(enum am335x_spi_controllers ctrl,
                     enum am335x_spi_channels channel, uint8_t* buffer,
                     size_t buffer_len) {
-    volatile struct am335x_spi_ctrl*    spi  = spi_ctrl[ctrl];
-    volatile struct am335x_spi_channel* chan = &spi->channel[channel];
+    return am335x_spi_xfer_ext(ctrl, channel, buffer, buffer, buffer_len);
+}
 
-    // enable channel
-    chan->chctrl |= LE32(CHCTRL_EN);
-    chan->chconf |= LE32(1 << 20);
+/* -------------------------------------------------------------------------- */
 
-    while (buffer_len--) {
-        while ((chan->chstat & LE32(CHSTAT_TXS)) == 0) continue;
-        chan->tx = LE32(*buffer);
-        while ((chan->chstat & LE32(CHSTAT_RXS)) == 0) continue;
-        *buffer++ = LE32(chan->rx) & 0xff;
-    }
+int am335x_spi_xfer_ext(enum am335x_spi_controllers ctrl,
+                        enum am335x_spi_channels channel, const uint8_t* tx,
+                        uint8_t* rx, size_t len) {
+    return transfer(ctrl, channel, tx, rx, len, sizeof(*tx));
+}
 
-    // wait until transfer complete
-    // while ((chan->chstat & CHSTAT_EOT) == 0) continue;
+/* -------------------------------------------------------------------------- */
 
-    // restore chconf
-    chan->chconf &= ~LE32(1 << 20);
-    // disable channel
-    chan->chctrl &= ~LE32(CHCTRL_EN);
+int am335x_spi_xfer16(enum am335x_spi_controllers ctrl,
+                      enum am335x_spi_channels channel, const uint16_t* tx,
+                      uint16_t* rx, size_t len) {
+    return transfer(ctrl, channel, (const uint8_t*)tx, (uint8_t*)rx, len,
+                    sizeof(*tx));
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_spi_xfer32(enum am335x_spi_controllers ctrl,
+                      enum am335x_spi_channels channel, const uint32_t* tx,
+                      uint32_t* rx, size_t len) {
+    return transfer(ctrl, channel, (const uint8_t*)tx, (uint8_t*)rx, len,
+                    sizeof(*tx));
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_spi_dma_xfer(enum am335x_spi_controllers ctrl,
+                        struct am335x_spi_dma_request* req) {
+    struct spi_port* port = &ports[ctrl];
+
+    if ((req->len == 0) || (req->len > 0xffff) ||
+        (req->channel > AM335X_CHAN1))
+        return -1;
+
+    uint32_t size = word_size(&spi_ctrl[ctrl]->channel[req->channel]);
+    if ((req->len % size) != 0) return -1;
+
+    req->next = 0;
+    req->done = false;
+
+    if (!port->dma) dma_init(ctrl);
+
+    port_lock(ctrl);
+    if (port->tail == 0) {
+        port->head = req;
+        port->tail = req;
+        dma_start(ctrl);
+    } else {
+        port->tail->next = req;
+        port->tail       = req;
+    }
+    port_unlock(ctrl);
 
     return 0;
 }
@@ -28,8 +28,13 @@
  * Date:    03.07.2015
  */
 
+#include <stdlib.h>
+
 #include "support.h"
 #include "am335x_clock.h"
+#include "am335x_edma.h"
+#include "am335x_irq.h"
+#include "am335x_mux.h"
 #include "am335x_uart.h"
 
 // define am335x uart controller registers
@@ -164,6 +169,10 @@ struct am335x_uart_ctrl {
 #define MCR_RTS                            (1 << 1)
 #define MCR_DTR                            (1 << 0)
 
+/* UART TCR register bit definition */
+#define TCR_RX_FIFO_TRIG_START(x)          ((((x) / 4) & 0xf) << 4)
+#define TCR_RX_FIFO_TRIG_HALT(x)           ((((x) / 4) & 0xf) << 0)
+
 /* UART MDR1 register bit definition */
 #define MDR1_FRAME_END_MODE                (1 << 7)
 #define MDR1_SIP_MODE                      (1 << 6)
@@ -209,6 +218,27 @@ struct am335x_uart_ctrl {
 #define LSR_RX_OE                          (1 << 1)
 #define LSR_RX_FIFO_E                      (1 << 0)
 
+/* UART IER register bit definition */
+#define IER_CTS_IT                         (1 << 7)
+#define IER_RTS_IT                         (1 << 6)
+#define IER_XOFF_IT                        (1 << 5)
+#define IER_SLEEP_MODE                     (1 << 4)
+#define IER_MODEM_STS_IT                   (1 << 3)
+#define IER_LINE_STS_IT                    (1 << 2)
+#define IER_THR_IT                         (1 << 1)
+#define IER_RHR_IT                         (1 << 0)
+
+/* UART IIR register bit definition */
+#define IIR_IT_TYPE_MASK                   (0x1f << 1)
+#define IIR_IT_TYPE_MODEM                  (0x00 << 1)
+#define IIR_IT_TYPE_THR                    (0x01 << 1)
+#define IIR_IT_TYPE_RHR                    (0x02 << 1)
+#define IIR_IT_TYPE_LINE_STS               (0x03 << 1)
+#define IIR_IT_TYPE_RX_TIMEOUT             (0x06 << 1)
+#define IIR_IT_TYPE_XOFF                   (0x08 << 1)
+#define IIR_IT_TYPE_CTS_RTS_DSR            (0x10 << 1)
+#define IIR_IT_PENDING                     (1 << 0)
+
 // am335x uart controllers memory mapped access register pointers
 static volatile struct am335x_uart_ctrl* uart_ctrl[] = {
     (struct am335x_uart_ctrl*)0x44e09000,  //  0
@@ -222,6 +252,34 @@ static volatile struct am335x_uart_ctrl* uart_ctrl[] = {
 // default uart configuration for serial line
 #define DEFAULT_BAUDRATE        115200
 #define UART_MODULE_INPUT_CLOCK 48000000
+#define UART_FIFO_SIZE          64
+
+// maximum accepted deviation of the generated baudrate
+#define BAUDRATE_MAX_ERROR_PPM  25000
+
+// largest divisor: 8 bits in DLL and 6 bits in DLH
+#define DIVISOR_MAX             0x3fff
+
+// macro to compute number of elements of an array
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+// default fifo configuration: rx trigger 60 chars, tx trigger 56 spaces
+#define DEFAULT_FCR  (FCR_RX_FIFO_TRIG_60CHAR | FCR_TX_FIFO_TRIG_56SPACES | \
+                      FCR_FIFO_EN)
+#define DEFAULT_TLR  ((60 << 4) + (56 << 0))
+#define DEFAULT_RX_THRESHOLD 60
+
+// dma fifo configuration: one dma request per character (granularity 1)
+#define DMA_FCR      (FCR_RX_FIFO_TRIG_16CHAR | FCR_TX_FIFO_TRIG_16SPACES | \
+                      FCR_DMA_MODE | FCR_FIFO_EN)
+#define DMA_TLR      (0)
+#define DMA_SCR      (SCR_RX_TRIG_GRANU1 | SCR_TX_TRIG_GRANU1 | \
+                      SCR_DMA_MODE_2_MODE1 | SCR_DMA_MODE_CTL)
+
+// size of the transmit and receive rings (must be a power of 2)
+#ifndef AM335X_UART_RING_SIZE
+#define AM335X_UART_RING_SIZE   1024
+#endif
 
 // table to convert uart interface to clock module number
 static const enum am335x_clock_uart_modules uart2clock[] = {
@@ -233,15 +291,452 @@ static const enum am335x_clock_uart_modules uart2clock[] = {
     AM335X_CLOCK_UART5,
 };
 
-// table to convert uart interface to clock module number
-// static const enum am335x_mux_uart_modules uart2mux[] = {
-//     AM335X_MUX_UART0,
-//     AM335X_MUX_UART1,
-//     AM335X_MUX_UART2,
-//     AM335X_MUX_UART3,
-//     AM335X_MUX_UART4,
-//     AM335X_MUX_UART5,
-// };
+// table to convert uart interface to mux module number
+static const enum am335x_mux_uart_modules uart2mux[] = {
+    AM335X_MUX_UART0,
+    AM335X_MUX_UART1,
+    AM335X_MUX_UART2,
+    AM335X_MUX_UART3,
+    AM335X_MUX_UART4,
+    AM335X_MUX_UART5,
+};
+
+// table to convert uart interface to interrupt controller line
+static const uint32_t uart2irq[] = {
+    SYS_INT_UART0INT,
+    SYS_INT_UART1INT,
+    SYS_INT_UART2INT,
+    SYS_INT_UART3INT,
+    SYS_INT_UART4INT,
+    SYS_INT_UART5INT,
+};
+
+// table to convert uart interface to edma channels, the events of uart3
+// to uart5 are routed through the crossbar onto otherwise unused channels
+static const struct uart_dma_events {
+    uint32_t tx;       // tx dma channel
+    uint32_t rx;       // rx dma channel
+    uint32_t tx_xbar;  // tx crossbar event (0 for direct event)
+    uint32_t rx_xbar;  // rx crossbar event (0 for direct event)
+} uart2dma[] = {
+    {26, 27, 0, 0},
+    {28, 29, 0, 0},
+    {30, 31, 0, 0},
+    {7, 8, 7, 8},
+    {9, 10, 9, 10},
+    {11, 12, 11, 12},
+};
+
+// PaRAM link sets reloaded by the rx ping-pong transfers
+#define RX_LINK_PARAMSET(ctrl, i) (64 + (ctrl) * 2 + (i))
+
+// single-producer/single-consumer ring, head is only written by the
+// producer and tail only by the consumer, both are free running counters
+struct uart_ring {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint8_t           buffer[AM335X_UART_RING_SIZE];
+};
+
+// dma transfer state
+struct uart_dma {
+    struct am335x_uart_dma_request* tx_head;
+    struct am335x_uart_dma_request* tx_tail;
+    uint8_t*                        rx_buf[2];
+    size_t                          rx_len;
+    uint32_t                        rx_index;
+    am335x_uart_dma_handler_t       rx_routine;
+    void*                           rx_param;
+};
+
+// rx burst delivery
+struct uart_burst {
+    uint32_t                 threshold;  // rx fifo trigger level
+    bool                     idle;       // deliver on rx timeout
+    am335x_uart_rx_handler_t routine;
+    void*                    param;
+};
+
+// uart controller context, each port is only ever serialized against its
+// own interrupt sources (see port_lock)
+struct uart_port {
+    enum am335x_uart_modes   mode;
+    struct uart_ring         tx;
+    struct uart_ring         rx;
+    struct uart_dma          dma;
+    struct uart_burst        burst;
+    struct am335x_uart_stats stats;      // line error counters
+    uint32_t                 baudrate;   // achieved baudrate
+    int32_t                  error_ppm;  // deviation from the requested rate
+};
+
+static struct uart_port ports[6];
+
+/* --------------------------------------------------------------------------
+ * implementation of local methods
+ * -------------------------------------------------------------------------- */
+
+/**
+ * method to enter a critical section against the interrupt sources of
+ * one port only: its interrupt controller line in interrupt mode or its
+ * dma completion interrupts in dma mode. other ports keep running.
+ *
+ * @return mode to be given back to port_unlock
+ */
+static enum am335x_uart_modes port_lock(enum am335x_uart_controllers ctrl) {
+    enum am335x_uart_modes mode = ports[ctrl].mode;
+    if (mode == AM335X_UART_INTERRUPT) {
+        IntSystemDisable(uart2irq[ctrl]);
+        (void)IntRawStatusGet(uart2irq[ctrl]);  // make sure the mask is set
+    } else if (mode == AM335X_UART_DMA) {
+        am335x_edma_mask_interrupt(uart2dma[ctrl].tx);
+        am335x_edma_mask_interrupt(uart2dma[ctrl].rx);
+    }
+    __sync_synchronize();
+    return mode;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void port_unlock(enum am335x_uart_controllers ctrl,
+                        enum am335x_uart_modes mode) {
+    __sync_synchronize();
+    if (mode == AM335X_UART_INTERRUPT) {
+        IntSystemEnable(uart2irq[ctrl]);
+    } else if (mode == AM335X_UART_DMA) {
+        am335x_edma_unmask_interrupt(uart2dma[ctrl].tx);
+        am335x_edma_unmask_interrupt(uart2dma[ctrl].rx);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t ring_used(const struct uart_ring* ring) {
+    return ring->head - ring->tail;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static size_t ring_put(struct uart_ring* ring, const uint8_t* data, size_t len) {
+    uint32_t head = ring->head;
+    uint32_t room = AM335X_UART_RING_SIZE - (head - ring->tail);
+    if (len > room) len = room;
+    for (size_t i = 0; i < len; i++)
+        ring->buffer[(head + i) & (AM335X_UART_RING_SIZE - 1)] = data[i];
+    __sync_synchronize();  // publish data before the new head
+    ring->head = head + len;
+    return len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static size_t ring_get(struct uart_ring* ring, uint8_t* data, size_t len) {
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+    if (len > used) len = used;
+    __sync_synchronize();  // read data only after having seen the head
+    for (size_t i = 0; i < len; i++)
+        data[i] = ring->buffer[(tail + i) & (AM335X_UART_RING_SIZE - 1)];
+    __sync_synchronize();  // release slots once data has been copied
+    ring->tail = tail + len;
+    return len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to read the line status register and to account an overrun,
+ * the overrun flag is cleared by the read
+ */
+static uint32_t read_lsr(volatile struct am335x_uart_ctrl* uart,
+                         struct am335x_uart_stats* stats) {
+    uint32_t lsr = LE32(uart->lsr);
+    if ((lsr & LSR_RX_OE) != 0) stats->overrun++;
+    return lsr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to account the errors of the character at the top of the rx fifo,
+ * to be called only when this character is popped: its framing, parity and
+ * break flags remain set in the line status register until then
+ */
+static inline void count_rx_errors(struct am335x_uart_stats* stats,
+                                   uint32_t lsr) {
+    if ((lsr & LSR_RX_FE) != 0) stats->framing++;
+    if ((lsr & LSR_RX_PE) != 0) stats->parity++;
+    if ((lsr & LSR_RX_BI) != 0) stats->breaks++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to pop the character at the top of the rx fifo and to account
+ * its line errors, only used when the rx fifo holds characters in error
+ */
+static inline uint8_t read_rhr(volatile struct am335x_uart_ctrl* uart,
+                               struct am335x_uart_stats* stats) {
+    count_rx_errors(stats, read_lsr(uart, stats));
+    return LE32(uart->rhr);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to check whether characters in error are waiting in the rx fifo.
+ * the level must be read before, so that all the characters it counts are
+ * covered by the line status register read here.
+ */
+static inline bool rx_errors(volatile struct am335x_uart_ctrl* uart,
+                             struct am335x_uart_stats* stats) {
+    return (read_lsr(uart, stats) & LSR_RX_FIFO_STS) != 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to move the content of the rx fifo into the rx ring
+ * characters are dropped if the ring is full. the line status is only
+ * read per character if the fifo holds characters in error.
+ *
+ * @return number of dropped characters
+ */
+static uint32_t rx_drain(volatile struct am335x_uart_ctrl* uart,
+                         struct uart_ring* ring,
+                         struct am335x_uart_stats* stats) {
+    uint32_t lvl     = LE32(uart->rxfifo_lvl);
+    bool     errors  = rx_errors(uart, stats);
+    uint32_t head    = ring->head;
+    uint32_t room    = AM335X_UART_RING_SIZE - (head - ring->tail);
+    uint32_t dropped = 0;
+    while (lvl-- > 0) {
+        uint8_t c = errors ? read_rhr(uart, stats) : LE32(uart->rhr);
+        if (room == 0) {
+            dropped++;
+            continue;
+        }
+        ring->buffer[head++ & (AM335X_UART_RING_SIZE - 1)] = c;
+        room--;
+    }
+    __sync_synchronize();
+    ring->head = head;
+    return dropped;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to refill the tx fifo from the tx ring
+ *
+ * @return true if the tx ring is empty
+ */
+static bool tx_refill(volatile struct am335x_uart_ctrl* uart,
+                      struct uart_ring* ring) {
+    uint32_t room = UART_FIFO_SIZE - LE32(uart->txfifo_lvl);
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+    if (room > used) room = used;
+    __sync_synchronize();
+    for (uint32_t i = 0; i < room; i++)
+        uart->thr = LE32(ring->buffer[tail++ & (AM335X_UART_RING_SIZE - 1)]);
+    __sync_synchronize();
+    ring->tail = tail;
+    return room == used;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to write as many characters as the tx fifo can hold
+ *
+ * @return number of characters written
+ */
+static size_t fifo_write(volatile struct am335x_uart_ctrl* uart,
+                         const uint8_t* data, size_t len) {
+    size_t room = UART_FIFO_SIZE - LE32(uart->txfifo_lvl);
+    if (room > len) room = len;
+    for (size_t i = 0; i < room; i++) uart->thr = LE32(data[i]);
+    return room;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to read the characters available in the rx fifo, the line status
+ * is only read per character if the fifo holds characters in error
+ *
+ * @return number of characters read
+ */
+static size_t fifo_read(volatile struct am335x_uart_ctrl* uart,
+                        struct am335x_uart_stats* stats, uint8_t* data,
+                        size_t len) {
+    size_t lvl = LE32(uart->rxfifo_lvl);
+    if (lvl == 0) return 0;
+    if (lvl > len) lvl = len;
+    if (rx_errors(uart, stats)) {
+        for (size_t i = 0; i < lvl; i++) data[i] = read_rhr(uart, stats);
+    } else {
+        for (size_t i = 0; i < lvl; i++) data[i] = LE32(uart->rhr);
+    }
+    return lvl;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to program the fifo control, trigger level and supplementary
+ * control registers, which are only accessible in configuration modes
+ */
+static void configure_fifo(volatile struct am335x_uart_ctrl* uart,
+                           uint32_t fifo_ctrl, uint32_t trig_level,
+                           uint32_t supp_ctrl) {
+    uint32_t lcr = LE32(uart->lcr);                // save lcr register
+    uart->lcr    = LE32(LCR_OPMODE_B);             // switch to configuration mode B
+    uint32_t efr = LE32(uart->efr);                // save efr register
+    uart->efr    = LE32(efr | EFR_ENHANCED_EN);    // enable writing to IER, FCR & MCR regs
+    uart->lcr    = LE32(LCR_OPMODE_A);             // switch to configuration mode A
+    uint32_t mcr = LE32(uart->mcr);                // save mcr register
+    uart->mcr    = LE32(mcr | MCR_TCR_TLR);        // enable access to TCR & TLR regs
+    uart->fcr    = LE32(fifo_ctrl);
+
+    uart->lcr = LE32(LCR_OPMODE_B);  // switch to configuration mode B
+    uart->tlr = LE32(trig_level);    // set new fifo trigger level
+    uart->scr = LE32(supp_ctrl);
+    uart->efr = LE32(efr);           // restore efr register
+    uart->lcr = LE32(LCR_OPMODE_A);  // switch to configuration mode A
+    uart->mcr = LE32(mcr);           // restore mcr register
+    uart->lcr = LE32(lcr);           // restore lcr register
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to program the rx fifo trigger level of the port with a one
+ * character granularity: TLR[7:4] gives the upper 4 bits, FCR[7:6] the
+ * lower 2 bits. the tx trigger level is left unchanged.
+ */
+static void configure_rx_fifo(enum am335x_uart_controllers ctrl) {
+    uint32_t threshold = ports[ctrl].burst.threshold;
+    uint32_t fcr = (DEFAULT_FCR & ~FCR_RX_FIFO_TRIG) | ((threshold & 3) << 6);
+    uint32_t tlr = (DEFAULT_TLR & 0x0f) | ((threshold >> 2) << 4);
+    configure_fifo(uart_ctrl[ctrl], fcr, tlr, SCR_RX_TRIG_GRANU1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void dma_start_tx(enum am335x_uart_controllers ctrl,
+                         const struct am335x_uart_dma_request* req) {
+    uint32_t channel = uart2dma[ctrl].tx;
+
+    // make the data visible to the dma controller
+    arm_flush_cache((uint32_t*)req->buf, req->len);
+
+    struct am335x_edma_transfer xfer = {
+        .src       = req->buf,
+        .dst       = &uart_ctrl[ctrl]->thr,
+        .acnt      = 1,
+        .bcnt      = req->len,
+        .src_bidx  = 1,
+        .dst_bidx  = 0,
+        .link      = AM335X_EDMA_NO_LINK,
+        .tcc       = channel,
+        .interrupt = true,
+    };
+    am335x_edma_setup(channel, &xfer);
+    am335x_edma_enable(channel);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void dma_tx_done(uint32_t channel, void* param) {
+    struct uart_port*            port = param;
+    enum am335x_uart_controllers ctrl = port - ports;
+
+    // keep the next uart request latched for the following transfer
+    am335x_edma_disable(channel);
+
+    struct am335x_uart_dma_request* req = port->dma.tx_head;
+    port->dma.tx_head                   = req->next;
+    if (port->dma.tx_head != 0) {
+        dma_start_tx(ctrl, port->dma.tx_head);
+    } else {
+        port->dma.tx_tail = 0;
+    }
+
+    if (req->routine != 0)
+        req->routine(ctrl, (void*)req->buf, req->len, req->param);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void dma_rx_done(uint32_t channel, void* param) {
+    struct uart_port*            port = param;
+    enum am335x_uart_controllers ctrl = port - ports;
+    (void)channel;
+
+    // the transfer has already been reloaded with the other buffer
+    uint8_t* buf       = port->dma.rx_buf[port->dma.rx_index];
+    port->dma.rx_index ^= 1;
+    arm_dcache_invalidate((uint32_t*)buf, port->dma.rx_len);
+
+    if (port->dma.rx_routine != 0)
+        port->dma.rx_routine(ctrl, buf, port->dma.rx_len, port->dma.rx_param);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void dma_enter(enum am335x_uart_controllers ctrl) {
+    const struct uart_dma_events* dma  = &uart2dma[ctrl];
+    struct uart_port*             port = &ports[ctrl];
+
+    am335x_edma_init();
+    if (dma->tx_xbar != 0) am335x_edma_map_event(dma->tx, dma->tx_xbar);
+    if (dma->rx_xbar != 0) am335x_edma_map_event(dma->rx, dma->rx_xbar);
+    am335x_edma_clear(dma->tx);
+    am335x_edma_clear(dma->rx);
+    am335x_edma_attach(dma->tx, dma_tx_done, port);
+    am335x_edma_attach(dma->rx, dma_rx_done, port);
+
+    port->dma.tx_head    = 0;
+    port->dma.tx_tail    = 0;
+    port->dma.rx_routine = 0;
+
+    configure_fifo(uart_ctrl[ctrl], DMA_FCR, DMA_TLR, DMA_SCR);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void dma_leave(enum am335x_uart_controllers ctrl) {
+    const struct uart_dma_events* dma  = &uart2dma[ctrl];
+    struct uart_port*             port = &ports[ctrl];
+
+    am335x_edma_disable(dma->tx);
+    am335x_edma_disable(dma->rx);
+    am335x_edma_attach(dma->tx, 0, 0);
+    am335x_edma_attach(dma->rx, 0, 0);
+
+    // the request in progress is given back with the number of bytes
+    // already sent, the queued ones with none
+    struct am335x_uart_dma_request* req  = port->dma.tx_head;
+    size_t                          sent = 0;
+    if (req != 0) sent = req->len - am335x_edma_remaining(dma->tx);
+    port->dma.tx_head = 0;
+    port->dma.tx_tail = 0;
+
+    am335x_edma_clear(dma->tx);
+    am335x_edma_clear(dma->rx);
+
+    while (req != 0) {
+        struct am335x_uart_dma_request* next = req->next;
+        if (req->routine != 0)
+            req->routine(ctrl, (void*)req->buf, sent, req->param);
+        sent = 0;
+        req  = next;
+    }
+
+    configure_rx_fifo(ctrl);
+}
 
 /* --------------------------------------------------------------------------
  * implementation of the public methods
@@ -254,41 +749,28 @@ void am335x_uart_init(enum am335x_uart_controllers ctrl) {
     am335x_clock_enable_uart_module(uart2clock[ctrl]);
 
     // setup uart pin multiplexing
-    // am335x_mux_setup_uart_pins(uart2mux[ctrl]);
+    am335x_mux_setup_uart_pins(uart2mux[ctrl]);
 
     // reset uart controller and wait until reset complete
     uart->sysc |= LE32(SYSC_SOFTRESET);
     while ((LE32(uart->syss) & SYSS_RESETDONE) == 0) {}
 
     // perform fifo configuration
-    uart->lcr    = LE32(LCR_OPMODE_B);     // switch to configuration mode B
-    uint32_t efr = LE32(uart->efr);        // save efr register
-    uart->efr    = LE32(EFR_ENHANCED_EN);  // enable writing to IER, FCR & MCR regs
-    uint32_t lcr = LE32(uart->lcr);        // save lcr register
-    uart->lcr    = LE32(LCR_OPMODE_A);     // switch to configuration mode A
-    uint32_t mcr = LE32(uart->mcr);        // save mcr register
-    uart->mcr    = LE32(MCR_TCR_TLR);      // enable access to TCR & TLR regs
-    uart->fcr    = LE32(FCR_RX_FIFO_TRIG_60CHAR | FCR_TX_FIFO_TRIG_56SPACES |
-                FCR_TX_FIFO_CLEAR | FCR_RX_FIFO_CLEAR | FCR_FIFO_EN);
-
-    uart->lcr = LE32(LCR_OPMODE_B);           // switch to configuration mode B
-    uart->tlr = LE32((60 << 4) + (56 << 0));  // set new fifo trigger level
-    uart->scr = LE32(0);                      // disable all...
-    uart->efr = LE32(efr);                    // restore efr register
-    uart->lcr = LE32(LCR_OPMODE_A);           // switch to configuration mode A
-    uart->mcr = LE32(mcr);                    // restore mcr register
-    uart->lcr = LE32(lcr);                    // restore lcr register
+    configure_fifo(uart, DEFAULT_FCR | FCR_TX_FIFO_CLEAR | FCR_RX_FIFO_CLEAR,
+                   DEFAULT_TLR, 0);
 
     // disable all interrupts and program line characteristics
     uart->mdr1 = LE32(MDR1_MODE_SELECT_DISABLED);  // disable uart
     uart->lcr  = LE32(LCR_OPMODE_B);               // switch to configuration mode B
-    efr        = LE32(uart->efr);                  // save efr register
+    uint32_t efr = LE32(uart->efr);                // save efr register
     uart->efr  = LE32(EFR_ENHANCED_EN);            // enable writing to IER, FCR & MCR regs
     uart->lcr  = LE32(LCR_OPMODE_NORMAL);          // switch mode access IER register
     uart->ier  = LE32(0x0);                        // clear IER bits
     uart->lcr  = LE32(LCR_OPMODE_B);
     uart->efr  = LE32(efr);                   // restore efr register
     uart->lcr  = LE32(LCR_CHAR_LENGTH_8BIT);  // 8 bit char
+    ports[ctrl].mode  = AM335X_UART_POLLING;
+    ports[ctrl].burst = (struct uart_burst){DEFAULT_RX_THRESHOLD, true, 0, 0};
 
     // perform baudrate configuration
     am335x_uart_set_baudrate(ctrl, DEFAULT_BAUDRATE);
@@ -296,8 +778,44 @@ void am335x_uart_init(enum am335x_uart_controllers ctrl) {
 
 /* -------------------------------------------------------------------------- */
 
-void am335x_uart_set_baudrate(enum am335x_uart_controllers ctrl, uint32_t baudrate) {
+int am335x_uart_set_baudrate(enum am335x_uart_controllers ctrl,
+                             uint32_t baudrate) {
     volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    static const struct {
+        uint32_t oversampling;
+        uint32_t mode;
+    } modes[] = {
+        {16, MDR1_MODE_SELECT_UART16X},
+        {13, MDR1_MODE_SELECT_UART13X},
+    };
+
+    if (baudrate == 0) return -1;
+
+    // search the oversampling mode and divisor with the lowest error,
+    // 16x is preferred on equal error for its better noise immunity
+    uint32_t mode     = 0;
+    uint32_t divider  = 0;
+    uint32_t achieved = 0;
+    int32_t  error    = 0;
+    for (unsigned i = 0; i < ARRAY_SIZE(modes); i++) {
+        uint64_t rate = (uint64_t)baudrate * modes[i].oversampling;
+        uint32_t div  = (UART_MODULE_INPUT_CLOCK + rate / 2) / rate;
+        if (div == 0) div = 1;
+        if (div > DIVISOR_MAX) div = DIVISOR_MAX;
+        uint32_t real = UART_MODULE_INPUT_CLOCK / (modes[i].oversampling * div);
+        int32_t  err =
+            (int32_t)(((int64_t)real - baudrate) * 1000000 / baudrate);
+        if ((divider == 0) || (abs(err) < abs(error))) {
+            mode     = modes[i].mode;
+            divider  = div;
+            achieved = real;
+            error    = err;
+        }
+    }
+    if (abs(error) > BAUDRATE_MAX_ERROR_PPM) return -1;
+
+    // prevent the interrupt handler from accessing the divider registers
+    enum am335x_uart_modes lock = port_lock(ctrl);
 
     // disable uart
     uart->mdr1 = LE32(MDR1_MODE_SELECT_DISABLED);
@@ -305,28 +823,51 @@ void am335x_uart_set_baudrate(enum am335x_uart_controllers ctrl, uint32_t baudra
     // configure divider value
     uint32_t lcr = LE32(uart->lcr);
     uart->lcr    = LE32(LCR_OPMODE_B);
-    if (baudrate > 230400) baudrate = 230400;
-    uint32_t divider = (UART_MODULE_INPUT_CLOCK / 16) / baudrate;
-    uart->dlh        = LE32(divider / 256);
-    uart->dll        = LE32(divider % 256);
-    uart->lcr        = LE32(lcr);
+    uart->dlh    = LE32(divider / 256);
+    uart->dll    = LE32(divider % 256);
+    uart->lcr    = LE32(lcr);
+
+    // select uart 16x or 13x mode
+    uart->mdr1 = LE32(mode);
+
+    ports[ctrl].baudrate  = achieved;
+    ports[ctrl].error_ppm = error;
+
+    port_unlock(ctrl, lock);
+
+    return 0;
+}
 
-    // select uart 16x mode
-    uart->mdr1 = LE32(MDR1_MODE_SELECT_UART16X);
+/* -------------------------------------------------------------------------- */
+
+uint32_t am335x_uart_get_baudrate(enum am335x_uart_controllers ctrl,
+                                  int32_t* error_ppm) {
+    if (error_ppm != 0) *error_ppm = ports[ctrl].error_ppm;
+    return ports[ctrl].baudrate;
 }
 
 /* -------------------------------------------------------------------------- */
 
 bool am335x_uart_tstc(enum am335x_uart_controllers ctrl) {
     volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
-    return ((uart->lsr & LE32(LSR_RX_FIFO_E)) != 0);
+    if (ports[ctrl].mode == AM335X_UART_INTERRUPT)
+        return ring_used(&ports[ctrl].rx) != 0;
+    return (read_lsr(uart, &ports[ctrl].stats) & LSR_RX_FIFO_E) != 0;
 }
 
 /* -------------------------------------------------------------------------- */
 
 int am335x_uart_read(enum am335x_uart_controllers ctrl) {
     volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
-    while ((uart->lsr & LE32(LSR_RX_FIFO_E)) == 0) {}
+    if (ports[ctrl].mode == AM335X_UART_INTERRUPT) {
+        uint8_t c;
+        while (ring_get(&ports[ctrl].rx, &c, 1) == 0) {}
+        return c;
+    }
+    struct am335x_uart_stats* stats = &ports[ctrl].stats;
+    uint32_t                  lsr;
+    while (((lsr = read_lsr(uart, stats)) & LSR_RX_FIFO_E) == 0) {}
+    count_rx_errors(stats, lsr);
     return LE32(uart->rhr);
 }
 
@@ -334,6 +875,301 @@ int am335x_uart_read(enum am335x_uart_controllers ctrl) {
 
 void am335x_uart_write(enum am335x_uart_controllers ctrl, int c) {
     volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    if (ports[ctrl].mode == AM335X_UART_INTERRUPT) {
+        uint8_t data = c;
+        while (am335x_uart_write_buf(ctrl, &data, 1) == 0) {}
+        return;
+    }
     while ((uart->ssr & LE32(SSR_TX_FIFO_FULL)) != 0) {}
     uart->thr = LE32(c);
 }
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_set_mode(enum am335x_uart_controllers ctrl,
+                          enum am335x_uart_modes mode) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    struct uart_port*                 port = &ports[ctrl];
+
+    // stop interrupt generation and dma before touching the rings
+    uart->ier = LE32(0);
+    if (port->mode == AM335X_UART_INTERRUPT) IntSystemDisable(uart2irq[ctrl]);
+    if (port->mode == AM335X_UART_DMA) dma_leave(ctrl);
+
+    port->tx.head = port->tx.tail = 0;
+    port->rx.head = port->rx.tail = 0;
+    port->mode    = mode;
+
+    // the tx interrupt is only enabled while the tx ring holds data
+    if (mode == AM335X_UART_INTERRUPT) {
+        uart->ier = LE32(IER_RHR_IT | IER_LINE_STS_IT);
+        IntSystemEnable(uart2irq[ctrl]);
+    }
+
+    if (mode == AM335X_UART_DMA) dma_enter(ctrl);
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t am335x_uart_write_buf(enum am335x_uart_controllers ctrl,
+                             const void* buf, size_t len) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    const uint8_t*                    data = buf;
+    size_t                            nb   = 0;
+
+    if (ports[ctrl].mode == AM335X_UART_INTERRUPT) {
+        nb = ring_put(&ports[ctrl].tx, data, len);
+        if (nb > 0) {
+            enum am335x_uart_modes lock = port_lock(ctrl);
+            uart->ier |= LE32(IER_THR_IT);
+            port_unlock(ctrl, lock);
+        }
+    } else {
+        nb = fifo_write(uart, data, len);
+    }
+    return nb;
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t am335x_uart_read_buf(enum am335x_uart_controllers ctrl, void* buf,
+                            size_t len) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    uint8_t*                          data = buf;
+    size_t                            nb   = 0;
+
+    if (ports[ctrl].mode == AM335X_UART_INTERRUPT) {
+        nb = ring_get(&ports[ctrl].rx, data, len);
+    } else {
+        nb = fifo_read(uart, &ports[ctrl].stats, data, len);
+    }
+    return nb;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_uart_set_rx_burst(enum am335x_uart_controllers ctrl,
+                             uint32_t threshold, bool idle,
+                             am335x_uart_rx_handler_t routine, void* param) {
+    struct uart_port* port = &ports[ctrl];
+
+    if ((threshold < 1) || (threshold > 63)) return -1;
+
+    enum am335x_uart_modes lock = port_lock(ctrl);
+    port->burst.threshold = threshold;
+    port->burst.idle      = idle;
+    port->burst.routine   = routine;
+    port->burst.param     = param;
+    if (port->mode != AM335X_UART_DMA) configure_rx_fifo(ctrl);
+    port_unlock(ctrl, lock);
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_uart_set_flow_control(enum am335x_uart_controllers ctrl,
+                                 bool enable, uint32_t halt,
+                                 uint32_t restore) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+
+    halt &= ~3;
+    restore &= ~3;
+    if (enable && ((halt < 4) || (halt > 60) || (restore >= halt))) return -1;
+
+    enum am335x_uart_modes lock = port_lock(ctrl);
+
+    uint32_t lcr = LE32(uart->lcr);                // save lcr register
+    uart->lcr    = LE32(LCR_OPMODE_B);             // switch to configuration mode B
+    uint32_t efr = LE32(uart->efr);                // save efr register
+    uart->efr    = LE32(efr | EFR_ENHANCED_EN);    // enable writing to IER, FCR & MCR regs
+    uart->lcr    = LE32(LCR_OPMODE_A);             // switch to configuration mode A
+    uint32_t mcr = LE32(uart->mcr);                // save mcr register
+    uart->mcr    = LE32(mcr | MCR_TCR_TLR);        // enable access to TCR & TLR regs
+    uart->tcr    = LE32(TCR_RX_FIFO_TRIG_START(restore) |
+                     TCR_RX_FIFO_TRIG_HALT(halt));
+
+    efr &= ~(EFR_AUTO_CTS_EN | EFR_AUTO_RTS_EN);
+    if (enable) efr |= EFR_AUTO_CTS_EN | EFR_AUTO_RTS_EN | EFR_ENHANCED_EN;
+    uart->lcr = LE32(LCR_OPMODE_B);  // switch to configuration mode B
+    uart->efr = LE32(efr);           // set auto flow control
+    uart->lcr = LE32(LCR_OPMODE_A);  // switch to configuration mode A
+    uart->mcr = LE32(mcr);           // restore mcr register
+    uart->lcr = LE32(lcr);           // restore lcr register
+
+    port_unlock(ctrl, lock);
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_set_loopback(enum am335x_uart_controllers ctrl, bool enable) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+
+    enum am335x_uart_modes lock = port_lock(ctrl);
+    if (enable)
+        uart->mcr |= LE32(MCR_LOOPBACK_EN);
+    else
+        uart->mcr &= ~LE32(MCR_LOOPBACK_EN);
+    port_unlock(ctrl, lock);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_get_stats(enum am335x_uart_controllers ctrl,
+                           struct am335x_uart_stats* stats) {
+    enum am335x_uart_modes lock = port_lock(ctrl);
+    *stats = ports[ctrl].stats;
+    port_unlock(ctrl, lock);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_reset_stats(enum am335x_uart_controllers ctrl) {
+    enum am335x_uart_modes lock = port_lock(ctrl);
+    ports[ctrl].stats = (struct am335x_uart_stats){0};
+    port_unlock(ctrl, lock);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_write_burst(enum am335x_uart_controllers ctrl,
+                             const void* buf, size_t len) {
+    const uint8_t* data = buf;
+    while (len > 0) {
+        size_t nb = am335x_uart_write_buf(ctrl, data, len);
+        data += nb;
+        len -= nb;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_read_burst(enum am335x_uart_controllers ctrl, void* buf,
+                            size_t len) {
+    uint8_t* data = buf;
+    while (len > 0) {
+        size_t nb = am335x_uart_read_buf(ctrl, data, len);
+        data += nb;
+        len -= nb;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_uart_dma_write(enum am335x_uart_controllers ctrl,
+                          struct am335x_uart_dma_request* req) {
+    struct uart_port* port = &ports[ctrl];
+
+    if ((port->mode != AM335X_UART_DMA) || (req->len == 0) ||
+        (req->len > 0xffff))
+        return -1;
+
+    req->next = 0;
+
+    enum am335x_uart_modes lock = port_lock(ctrl);
+    if (port->dma.tx_tail == 0) {
+        port->dma.tx_head = req;
+        port->dma.tx_tail = req;
+        dma_start_tx(ctrl, req);
+    } else {
+        port->dma.tx_tail->next = req;
+        port->dma.tx_tail       = req;
+    }
+    port_unlock(ctrl, lock);
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int am335x_uart_dma_start_read(enum am335x_uart_controllers ctrl, void* buf0,
+                               void* buf1, size_t len,
+                               am335x_uart_dma_handler_t routine, void* param) {
+    struct uart_port* port    = &ports[ctrl];
+    uint32_t          channel = uart2dma[ctrl].rx;
+
+    if ((port->mode != AM335X_UART_DMA) || (len == 0) || (len > 0xffff))
+        return -1;
+
+    am335x_uart_dma_stop_read(ctrl);
+
+    port->dma.rx_buf[0]  = buf0;
+    port->dma.rx_buf[1]  = buf1;
+    port->dma.rx_len     = len;
+    port->dma.rx_index   = 0;
+    port->dma.rx_routine = routine;
+    port->dma.rx_param   = param;
+    arm_dcache_invalidate((uint32_t*)buf0, len);
+    arm_dcache_invalidate((uint32_t*)buf1, len);
+
+    // each buffer reloads the other one at completion
+    struct am335x_edma_transfer xfer = {
+        .src       = &uart_ctrl[ctrl]->rhr,
+        .dst       = buf0,
+        .acnt      = 1,
+        .bcnt      = len,
+        .src_bidx  = 0,
+        .dst_bidx  = 1,
+        .link      = RX_LINK_PARAMSET(ctrl, 1),
+        .tcc       = channel,
+        .interrupt = true,
+    };
+    am335x_edma_setup(channel, &xfer);
+    am335x_edma_setup(RX_LINK_PARAMSET(ctrl, 0), &xfer);
+    xfer.dst  = buf1;
+    xfer.link = RX_LINK_PARAMSET(ctrl, 0);
+    am335x_edma_setup(RX_LINK_PARAMSET(ctrl, 1), &xfer);
+
+    am335x_edma_enable(channel);
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_dma_stop_read(enum am335x_uart_controllers ctrl) {
+    uint32_t channel = uart2dma[ctrl].rx;
+
+    am335x_edma_disable(channel);
+    am335x_edma_clear(channel);
+    ports[ctrl].dma.rx_routine = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void am335x_uart_interrupt_handler(enum am335x_uart_controllers ctrl) {
+    volatile struct am335x_uart_ctrl* uart = uart_ctrl[ctrl];
+    struct uart_port*                 port = &ports[ctrl];
+
+    uint32_t iir;
+    while (((iir = LE32(uart->iir)) & IIR_IT_PENDING) == 0) {
+        switch (iir & IIR_IT_TYPE_MASK) {
+            case IIR_IT_TYPE_LINE_STS:
+                // acknowledge the line status error, the characters in
+                // error are accounted as they are drained
+                (void)read_lsr(uart, &port->stats);
+                port->stats.dropped += rx_drain(uart, &port->rx, &port->stats);
+                break;
+
+            case IIR_IT_TYPE_RHR:
+            case IIR_IT_TYPE_RX_TIMEOUT:
+                port->stats.dropped += rx_drain(uart, &port->rx, &port->stats);
+                if ((port->burst.routine != 0) &&
+                    (((iir & IIR_IT_TYPE_MASK) == IIR_IT_TYPE_RHR) ||
+                     port->burst.idle))
+                    port->burst.routine(ctrl, ring_used(&port->rx),
+                                        port->burst.param);
+                break;
+
+            case IIR_IT_TYPE_THR:
+                if (tx_refill(uart, &port->tx)) uart->ier &= ~LE32(IER_THR_IT);
+                break;
+
+            default:
+                (void)uart->msr;  // acknowledge modem status change
+                break;
+        }
+    }
+}
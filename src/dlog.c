@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Deferred binary logging
+ *
+ * Purpose: This module implements the RAM ring storing the binary log
+ *          frames and its drain to UART0.
+ */
+
+#include <stdint.h>
+
+#include "am335x_dmtimer1.h"
+#include "am335x_irq.h"
+#include "am335x_uart.h"
+#include "dlog.h"
+
+// size of the log ring in bytes (must be a power of 2)
+#ifndef DLOG_RING_SIZE
+#define DLOG_RING_SIZE 4096
+#endif
+
+#define FRAME_SYNC        0xa5
+#define FRAME_HEADER_SIZE 10
+#define FRAME_LOST_SIZE   (FRAME_HEADER_SIZE + 4)
+
+// ring of wire frames, head is advanced by the producers with interrupts
+// disabled, tail only by the drain
+static struct dlog_ring {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t          lost;   // frames lost since the last lost frame
+    uint32_t          total;  // frames lost since startup
+    uint8_t           buffer[DLOG_RING_SIZE];
+} ring;
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t put_byte(uint32_t head, uint8_t value) {
+    ring.buffer[head & (DLOG_RING_SIZE - 1)] = value;
+    return head + 1;
+}
+
+static inline uint32_t put_word(uint32_t head, uint32_t value) {
+    const uint8_t* p = (const uint8_t*)&value;
+    head             = put_byte(head, p[0]);
+    head             = put_byte(head, p[1]);
+    head             = put_byte(head, p[2]);
+    return put_byte(head, p[3]);
+}
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+void dlog_record(const char* fmt, const uint32_t* args, uint32_t nargs) {
+    uint32_t size = FRAME_HEADER_SIZE + nargs * 4;
+
+    // the counter is read with interrupts disabled, so that the timestamps
+    // of the frames increase in the ring order
+    uint8_t  status    = IntDisable();
+    uint32_t timestamp = am335x_dmtimer1_get_counter();
+    uint32_t head      = ring.head;
+    uint32_t room      = DLOG_RING_SIZE - (head - ring.tail);
+
+    // report the frames lost so far as soon as there is room again
+    if ((ring.lost != 0) && (room >= FRAME_LOST_SIZE + size)) {
+        head = put_byte(head, FRAME_SYNC);
+        head = put_byte(head, 1);
+        head = put_word(head, 0);
+        head = put_word(head, timestamp);
+        head = put_word(head, ring.lost);
+        room -= FRAME_LOST_SIZE;
+        ring.lost = 0;
+    }
+
+    if ((ring.lost != 0) || (room < size)) {
+        ring.lost++;
+        ring.total++;
+    } else {
+        head = put_byte(head, FRAME_SYNC);
+        head = put_byte(head, nargs);
+        head = put_word(head, (uintptr_t)fmt);
+        head = put_word(head, timestamp);
+        for (uint32_t i = 0; i < nargs; i++) head = put_word(head, args[i]);
+        ring.head = head;
+    }
+    IntEnable(status);
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t dlog_drain(void) {
+    uint32_t tail = ring.tail;
+    uint32_t used = ring.head - tail;
+
+    // send the contiguous part up to the end of the buffer
+    uint32_t index = tail & (DLOG_RING_SIZE - 1);
+    uint32_t len   = DLOG_RING_SIZE - index;
+    if (len > used) len = used;
+    if (len > 0) {
+        len = am335x_uart_write_buf(AM335X_UART0, &ring.buffer[index], len);
+        ring.tail = tail + len;
+    }
+    return used - len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t dlog_get_lost(void) { return ring.total; }
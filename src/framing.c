@@ -0,0 +1,292 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Packet framing (COBS / SLIP) with CRC
+ *
+ * Purpose: This module implements the in place encoders and the streaming
+ *          decoders of the COBS and SLIP framings. The frame check
+ *          sequence is verified with the crc residue, i.e. the crc computed
+ *          over the payload followed by its crc, which does not require to
+ *          know where the payload ends while the bytes are arriving.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "framing.h"
+
+// SLIP special characters
+#define SLIP_END     0xc0
+#define SLIP_ESC     0xdb
+#define SLIP_ESC_END 0xdc
+#define SLIP_ESC_ESC 0xdd
+
+// crc residues computed over a payload followed by its crc
+#define CRC16_RESIDUE 0x0000
+#define CRC32_RESIDUE 0xdebb20e3  // before the final inversion
+
+// crc lookup tables, processed 4 bits at a time
+static const uint16_t crc16_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+static const uint32_t crc32_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint16_t crc16_update(uint16_t crc, uint8_t data) {
+    crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (data >> 4)];
+    crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (data & 0xf)];
+    return crc;
+}
+
+static inline uint32_t crc32_update(uint32_t crc, uint8_t data) {
+    crc = (crc >> 4) ^ crc32_table[(crc ^ data) & 0xf];
+    crc = (crc >> 4) ^ crc32_table[(crc ^ (data >> 4)) & 0xf];
+    return crc;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static size_t crc_size(enum framing_crcs crc_type) {
+    if (crc_type == FRAMING_CRC16) return 2;
+    if (crc_type == FRAMING_CRC32) return 4;
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static size_t cobs_encode(uint8_t* buf, size_t len, size_t size) {
+    // move the data behind the worst case overhead, so that the encoded
+    // frame written from the start never overtakes the data still to read
+    size_t overhead = 1 + len / 254;
+    if (len + overhead + 1 > size) return 0;
+    memmove(buf + overhead, buf, len);
+
+    const uint8_t* src  = buf + overhead;
+    size_t         out  = 1;
+    size_t         pos  = 0;  // position of the current code byte
+    uint8_t        code = 1;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = src[i];
+        if (c == 0) {
+            buf[pos] = code;
+            pos      = out++;
+            code     = 1;
+        } else {
+            buf[out++] = c;
+            if (++code == 0xff) {
+                buf[pos] = code;
+                pos      = out++;
+                code     = 1;
+            }
+        }
+    }
+    buf[pos]   = code;
+    buf[out++] = 0;
+    return out;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static size_t slip_encode(uint8_t* buf, size_t len, size_t size) {
+    size_t specials = 0;
+    for (size_t i = 0; i < len; i++)
+        if ((buf[i] == SLIP_END) || (buf[i] == SLIP_ESC)) specials++;
+
+    size_t out = len + specials + 1;
+    if (out > size) return 0;
+
+    // expand backwards, the tail never overwrites data still to read
+    size_t j = out - 1;
+    buf[j]   = SLIP_END;
+    for (size_t i = len; i-- > 0;) {
+        uint8_t c = buf[i];
+        if (c == SLIP_END) {
+            buf[--j] = SLIP_ESC_END;
+            buf[--j] = SLIP_ESC;
+        } else if (c == SLIP_ESC) {
+            buf[--j] = SLIP_ESC_ESC;
+            buf[--j] = SLIP_ESC;
+        } else {
+            buf[--j] = c;
+        }
+    }
+    return out;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void decoder_reset(struct framing_decoder* dec) {
+    dec->len     = 0;
+    dec->crc     = (dec->crc_type == FRAMING_CRC16) ? 0xffff : 0xffffffff;
+    dec->code    = 0;
+    dec->left    = 0;
+    dec->escape  = false;
+    dec->discard = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline void decoder_emit(struct framing_decoder* dec, uint8_t c) {
+    if (dec->len >= dec->size) {
+        dec->discard = true;
+        return;
+    }
+    dec->buf[dec->len++] = c;
+    if (dec->crc_type == FRAMING_CRC16)
+        dec->crc = crc16_update(dec->crc, c);
+    else if (dec->crc_type == FRAMING_CRC32)
+        dec->crc = crc32_update(dec->crc, c);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void decoder_end(struct framing_decoder* dec) {
+    size_t fcs = crc_size(dec->crc_type);
+
+    // empty frames (back-to-back delimiters) are silently ignored
+    if ((dec->len == 0) && !dec->discard && !dec->escape) {
+        decoder_reset(dec);
+        return;
+    }
+
+    bool valid = !dec->discard && !dec->escape && (dec->left == 0) &&
+                 (dec->len >= fcs);
+    if (dec->crc_type == FRAMING_CRC16)
+        valid = valid && ((dec->crc & 0xffff) == CRC16_RESIDUE);
+    else if (dec->crc_type == FRAMING_CRC32)
+        valid = valid && (dec->crc == CRC32_RESIDUE);
+
+    if (!valid)
+        dec->errors++;
+    else if (dec->routine != 0)
+        dec->routine(dec->param, dec->buf, dec->len - fcs);
+
+    decoder_reset(dec);
+}
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+uint16_t framing_crc16(uint16_t crc, const void* data, size_t len) {
+    const uint8_t* p = data;
+    while (len-- > 0) crc = crc16_update(crc, *p++);
+    return crc;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t framing_crc32(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = data;
+    crc              = ~crc;
+    while (len-- > 0) crc = crc32_update(crc, *p++);
+    return ~crc;
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t framing_encode(enum framing_types type, enum framing_crcs crc_type,
+                      uint8_t* buf, size_t len, size_t size) {
+    size_t fcs = crc_size(crc_type);
+    if (len + fcs > size) return 0;
+
+    if (crc_type == FRAMING_CRC16) {
+        uint16_t crc = framing_crc16(0xffff, buf, len);
+        buf[len++]   = crc >> 8;
+        buf[len++]   = crc;
+    } else if (crc_type == FRAMING_CRC32) {
+        uint32_t crc = framing_crc32(0, buf, len);
+        buf[len++]   = crc;
+        buf[len++]   = crc >> 8;
+        buf[len++]   = crc >> 16;
+        buf[len++]   = crc >> 24;
+    }
+
+    if (type == FRAMING_COBS) return cobs_encode(buf, len, size);
+    return slip_encode(buf, len, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void framing_decoder_init(struct framing_decoder* dec, enum framing_types type,
+                          enum framing_crcs crc_type, uint8_t* buf,
+                          size_t size, framing_handler_t routine,
+                          void* param) {
+    dec->type     = type;
+    dec->crc_type = crc_type;
+    dec->buf      = buf;
+    dec->size     = size;
+    dec->routine  = routine;
+    dec->param    = param;
+    dec->errors   = 0;
+    decoder_reset(dec);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void framing_decoder_push(struct framing_decoder* dec, const uint8_t* data,
+                          size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+
+        if (dec->type == FRAMING_COBS) {
+            if (c == 0) {
+                decoder_end(dec);
+            } else if (dec->discard) {
+                continue;
+            } else if (dec->left == 0) {
+                // the zero ending the previous block is implicit, except
+                // after a full block or at the frame start
+                if ((dec->code != 0) && (dec->code != 0xff))
+                    decoder_emit(dec, 0);
+                dec->code = c;
+                dec->left = c - 1;
+            } else {
+                decoder_emit(dec, c);
+                dec->left--;
+            }
+
+        } else {
+            if (c == SLIP_END) {
+                decoder_end(dec);
+            } else if (dec->discard) {
+                continue;
+            } else if (dec->escape) {
+                dec->escape = false;
+                if (c == SLIP_ESC_END)
+                    decoder_emit(dec, SLIP_END);
+                else if (c == SLIP_ESC_ESC)
+                    decoder_emit(dec, SLIP_ESC);
+                else
+                    dec->discard = true;
+            } else if (c == SLIP_ESC) {
+                dec->escape = true;
+            } else {
+                decoder_emit(dec, c);
+            }
+        }
+    }
+}
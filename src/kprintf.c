@@ -0,0 +1,539 @@
+/**
+ * Copyright 2026 University of Applied Sciences Western Switzerland / Fribourg
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Project: HEIA-FR / Embedded Systems 1+2 Laboratory
+ *
+ * Abstract: Kernel formatted output
+ *
+ * Purpose: This module implements a small printf-like formatter writing
+ *          either into a caller buffer or straight to the console uart,
+ *          without any heap, locale or stdio support.
+ *          Supported conversions: %d %i %u %x %X %o %p %s %c %% with the
+ *          flags '-', '0', '+', ' ', '#', field width, precision and the
+ *          length modifiers hh, h, l, ll, z, j and t.
+ *          %f is supported when compiled with KPRINTF_FLOAT.
+ */
+
+#include <float.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "support.h"
+#include "am335x_uart.h"
+
+// conversion flags
+#define FLAG_LEFT  (1 << 0)
+#define FLAG_ZERO  (1 << 1)
+#define FLAG_PLUS  (1 << 2)
+#define FLAG_SPACE (1 << 3)
+#define FLAG_ALT   (1 << 4)
+#define FLAG_UPPER (1 << 5)
+
+// size of the console staging buffer
+#define CONSOLE_BUFFER_SIZE 64
+
+// %f fraction: largest fixed point value, leaving room for the product
+// by 5 in 64 bits, and number of digits produced
+#define FRACTION_MAX    ((uint64_t)1 << 61)
+#define FRACTION_DIGITS 40
+
+// output channel, characters are stored in buf and handed over to flush
+// once the buffer is full. without flush method, the output is truncated.
+struct output {
+    char*  buf;
+    size_t size;
+    size_t len;
+    size_t total;
+    void (*flush)(struct output* out);
+};
+
+/* -------------------------------------------------------------------------- */
+
+static void put_char(struct output* out, char c) {
+    if (out->len >= out->size) {
+        if (out->flush == 0) {
+            out->total++;
+            return;
+        }
+        out->flush(out);
+    }
+    out->buf[out->len++] = c;
+    out->total++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void put_repeat(struct output* out, char c, int nb) {
+    while (nb-- > 0) put_char(out, c);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to emit the start of a conversion of len characters (prefix
+ * excluded): the padding to the field width and the prefix (sign, 0x)
+ *
+ * @return number of spaces to append to a left justified conversion
+ */
+static int put_head(struct output* out, const char* prefix, size_t len,
+                    int width, unsigned flags) {
+    size_t plen = 0;
+    while (prefix[plen] != 0) plen++;
+
+    int pad = width - (int)(plen + len);
+    if ((flags & (FLAG_LEFT | FLAG_ZERO)) == 0) put_repeat(out, ' ', pad);
+    for (size_t i = 0; i < plen; i++) put_char(out, prefix[i]);
+    if ((flags & (FLAG_LEFT | FLAG_ZERO)) == FLAG_ZERO)
+        put_repeat(out, '0', pad);
+    return ((flags & FLAG_LEFT) != 0) ? pad : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to emit a conversion: prefix (sign, 0x), leading zeros and digits
+ * padded to the field width
+ */
+static void put_field(struct output* out, const char* prefix,
+                      const char* body, size_t len, int zeros, int width,
+                      unsigned flags) {
+    if (zeros < 0) zeros = 0;
+    int pad = put_head(out, prefix, len + zeros, width, flags);
+    put_repeat(out, '0', zeros);
+    for (size_t i = 0; i < len; i++) put_char(out, body[i]);
+    put_repeat(out, ' ', pad);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to convert an unsigned value into digits, written backwards
+ * from the end of the buffer. 64-bit divisions are only used as long as
+ * the value does not fit into 32 bits.
+ *
+ * @return number of digits
+ */
+static size_t to_digits(char* end, uint64_t value, unsigned base,
+                        unsigned flags) {
+    const char* digits =
+        (flags & FLAG_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char* p = end;
+
+    if (base == 16) {
+        do {
+            *--p = digits[value & 0xf];
+            value >>= 4;
+        } while (value != 0);
+    } else if (base == 8) {
+        do {
+            *--p = digits[value & 0x7];
+            value >>= 3;
+        } while (value != 0);
+    } else {
+        while ((value >> 32) != 0) {
+            *--p = digits[value % 10];
+            value /= 10;
+        }
+        uint32_t v = value;
+        do {
+            *--p = digits[v % 10];
+            v /= 10;
+        } while (v != 0);
+    }
+    return end - p;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void put_integer(struct output* out, uint64_t value, bool negative,
+                        unsigned base, int width, int precision,
+                        unsigned flags) {
+    char   buf[24];
+    char   prefix[3] = {0};
+    size_t len       = 0;
+
+    if ((precision != 0) || (value != 0))
+        len = to_digits(buf + sizeof(buf), value, base, flags);
+
+    if (negative) {
+        prefix[0] = '-';
+    } else if ((flags & FLAG_PLUS) != 0) {
+        prefix[0] = '+';
+    } else if ((flags & FLAG_SPACE) != 0) {
+        prefix[0] = ' ';
+    } else if ((flags & FLAG_ALT) != 0) {
+        if ((base == 16) && (value != 0)) {
+            prefix[0] = '0';
+            prefix[1] = (flags & FLAG_UPPER) ? 'X' : 'x';
+        }
+        // the alternate octal form starts with a 0, even for a null value
+        // printed with a null precision
+        if ((base == 8) && (precision <= (int)len) &&
+            ((value != 0) || (len == 0)))
+            precision = len + 1;
+    }
+
+    // an explicit precision disables zero padding
+    int zeros = 0;
+    if (precision >= 0) {
+        zeros = precision - (int)len;
+        flags &= ~FLAG_ZERO;
+    }
+    put_field(out, prefix, buf + sizeof(buf) - len, len, zeros, width, flags);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef KPRINTF_FLOAT
+/**
+ * method to emit a %f conversion. values beyond 64 bits are scaled down by
+ * powers of 10, their digits beyond the 15 to 17 significant ones held by a
+ * double are not exact. the fraction is converted to a fixed point number
+ * whose digits are produced one by one and rounded to nearest, ties to
+ * even, as the C library does; the digits beyond FRACTION_DIGITS are zeros.
+ */
+static void put_float(struct output* out, double value, int width,
+                      int precision, unsigned flags) {
+    char        buf[24];
+    char        digits[FRACTION_DIGITS];
+    const char* prefix = "";
+
+    if (precision < 0) precision = 6;
+
+    // the sign bit is tested so that -0.0 keeps its sign
+    if (__builtin_signbit(value)) {
+        prefix = "-";
+        value  = -value;
+    } else if ((flags & FLAG_PLUS) != 0) {
+        prefix = "+";
+    } else if ((flags & FLAG_SPACE) != 0) {
+        prefix = " ";
+    }
+
+    if (value != value) {
+        put_field(out, prefix, "nan", 3, 0, width, flags & ~FLAG_ZERO);
+        return;
+    }
+    if (value > DBL_MAX) {
+        put_field(out, prefix, "inf", 3, 0, width, flags & ~FLAG_ZERO);
+        return;
+    }
+
+    // bring the integer part into 64 bits, the dropped digits are zeros
+    // since a double beyond 2^53 has no fraction
+    int exponent = 0;
+    while (value >= 1e35) {
+        value /= 1e16;
+        exponent += 16;
+    }
+    while (value >= 18446744073709551616.0) {
+        value /= 10;
+        exponent++;
+    }
+    uint64_t integer = value;
+
+    // fraction as the fixed point number fraction / 2^bits, shifted until
+    // exact, the 53 bits of a double always fit below FRACTION_MAX
+    double rest = (exponent == 0) ? value - integer : 0;
+    int    bits = 0;
+    while ((rest != (uint64_t)rest) && (rest < FRACTION_MAX)) {
+        rest *= 2;
+        bits++;
+    }
+    uint64_t fraction = rest;
+    bool     sticky   = false;  // non-zero bits dropped below the fraction
+
+    // a digit is fraction * 10 / 2^bits = fraction * 5 / 2^(bits-1), low
+    // bits are dropped when the product would no longer fit in 64 bits.
+    // while bits is beyond 64, the digits are the leading zeros.
+    int nb = (precision < FRACTION_DIGITS) ? precision : FRACTION_DIGITS;
+    for (int i = 0; i < nb; i++) {
+        fraction *= 5;
+        bits--;
+        if (bits >= 64) {
+            digits[i] = '0';
+        } else {
+            digits[i] = '0' + (fraction >> bits);
+            fraction &= (UINT64_C(1) << bits) - 1;
+        }
+        while (fraction >= FRACTION_MAX) {
+            sticky = sticky || ((fraction & 1) != 0);
+            fraction >>= 1;
+            bits--;
+        }
+    }
+
+    // round to nearest, ties to even; beyond 64 bits the fraction is below
+    // FRACTION_MAX hence below the half
+    if ((bits > 0) && (bits <= 64)) {
+        uint64_t half = UINT64_C(1) << (bits - 1);
+        unsigned last = (nb > 0) ? (unsigned)(digits[nb - 1] - '0')
+                                 : (unsigned)(integer % 10);
+        if ((fraction > half) ||
+            ((fraction == half) && (sticky || ((last & 1) != 0)))) {
+            int i = nb - 1;
+            while ((i >= 0) && (digits[i] == '9')) digits[i--] = '0';
+            if (i >= 0)
+                digits[i]++;
+            else
+                integer++;
+        }
+    }
+
+    size_t len   = to_digits(buf + sizeof(buf), integer, 10, 0);
+    bool   point = (precision > 0) || ((flags & FLAG_ALT) != 0);
+    size_t total = len + exponent + (point ? 1 : 0) + precision;
+
+    int pad = put_head(out, prefix, total, width, flags);
+    for (size_t i = sizeof(buf) - len; i < sizeof(buf); i++)
+        put_char(out, buf[i]);
+    put_repeat(out, '0', exponent);
+    if (point) put_char(out, '.');
+    for (int i = 0; i < nb; i++) put_char(out, digits[i]);
+    put_repeat(out, '0', precision - nb);
+    put_repeat(out, ' ', pad);
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+static void format(struct output* out, const char* fmt, va_list ap) {
+    while (*fmt != 0) {
+        // copy plain text up to the next conversion
+        if (*fmt != '%') {
+            put_char(out, *fmt++);
+            continue;
+        }
+        fmt++;
+
+        unsigned flags = 0;
+        for (;; fmt++) {
+            if (*fmt == '-')
+                flags |= FLAG_LEFT;
+            else if (*fmt == '0')
+                flags |= FLAG_ZERO;
+            else if (*fmt == '+')
+                flags |= FLAG_PLUS;
+            else if (*fmt == ' ')
+                flags |= FLAG_SPACE;
+            else if (*fmt == '#')
+                flags |= FLAG_ALT;
+            else
+                break;
+        }
+
+        int width = 0;
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while ((*fmt >= '0') && (*fmt <= '9'))
+                width = width * 10 + (*fmt++ - '0');
+        }
+
+        int precision = -1;
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(ap, int);
+                fmt++;
+            } else {
+                while ((*fmt >= '0') && (*fmt <= '9'))
+                    precision = precision * 10 + (*fmt++ - '0');
+            }
+        }
+
+        // length modifier: number of long, -1 for short, -2 for char
+        int length = 0;
+        for (;; fmt++) {
+            if (*fmt == 'l')
+                length++;
+            else if (*fmt == 'h')
+                length--;
+            else if (*fmt == 'j')
+                length = 2;
+            else if ((*fmt == 'z') || (*fmt == 't'))
+                length = (sizeof(size_t) > sizeof(int)) ? 1 : 0;
+            else
+                break;
+        }
+
+        char     conv     = *fmt++;
+        unsigned base     = 10;
+        uint64_t value    = 0;
+        bool     negative = false;
+        switch (conv) {
+            case 'd':
+            case 'i': {
+                int64_t v;
+                if (length >= 2)
+                    v = va_arg(ap, long long);
+                else if (length == 1)
+                    v = va_arg(ap, long);
+                else
+                    v = va_arg(ap, int);
+                if (length == -1) v = (short)v;
+                if (length <= -2) v = (signed char)v;
+                negative = v < 0;
+                value    = negative ? -(uint64_t)v : (uint64_t)v;
+                put_integer(out, value, negative, 10, width, precision, flags);
+                break;
+            }
+
+            case 'X':
+                flags |= FLAG_UPPER;
+                // fall through
+            case 'x':
+                base = 16;
+                // fall through
+            case 'o':
+                if (conv == 'o') base = 8;
+                // fall through
+            case 'u':
+                if (length >= 2)
+                    value = va_arg(ap, unsigned long long);
+                else if (length == 1)
+                    value = va_arg(ap, unsigned long);
+                else
+                    value = va_arg(ap, unsigned);
+                if (length == -1) value = (unsigned short)value;
+                if (length <= -2) value = (unsigned char)value;
+                flags &= ~(FLAG_PLUS | FLAG_SPACE);
+                put_integer(out, value, false, base, width, precision, flags);
+                break;
+
+            case 'p':
+                value = (uintptr_t)va_arg(ap, void*);
+                put_integer(out, value, false, 16, width, -1,
+                            FLAG_ALT | (flags & FLAG_LEFT));
+                break;
+
+            case 'c': {
+                char c = va_arg(ap, int);
+                put_field(out, "", &c, 1, 0, width, flags & FLAG_LEFT);
+                break;
+            }
+
+            case 's': {
+                const char* s = va_arg(ap, const char*);
+                if (s == 0) s = "(null)";
+                size_t len = 0;
+                while ((s[len] != 0) && ((precision < 0) ||
+                                         (len < (size_t)precision)))
+                    len++;
+                put_field(out, "", s, len, 0, width, flags & FLAG_LEFT);
+                break;
+            }
+
+#ifdef KPRINTF_FLOAT
+            case 'f':
+            case 'F':
+                put_float(out, va_arg(ap, double), width, precision, flags);
+                break;
+#endif
+
+            case '%':
+                put_char(out, '%');
+                break;
+
+            case 0:
+                // format string ends within a conversion
+                return;
+
+            default:
+                // unsupported conversion, print it as is
+                put_char(out, '%');
+                put_char(out, conv);
+                break;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * method to send the staging buffer to the console, expanding the line
+ * endings as am335x_console_putc does
+ */
+static void console_flush(struct output* out) {
+    char   buf[CONSOLE_BUFFER_SIZE * 2];
+    size_t nb = 0;
+    for (size_t i = 0; i < out->len; i++) {
+        char c    = out->buf[i];
+        buf[nb++] = c;
+        if (c == '\n') buf[nb++] = '\r';
+        if (c == '\r') buf[nb++] = '\n';
+    }
+    am335x_uart_write_burst(AM335X_UART0, buf, nb);
+    out->len = 0;
+}
+
+/* --------------------------------------------------------------------------
+ * implementation of the public methods
+ * -------------------------------------------------------------------------- */
+
+int kvsnprintf(char* buf, size_t size, const char* fmt, va_list ap) {
+    struct output out = {
+        .buf   = buf,
+        .size  = (size > 0) ? size - 1 : 0,
+        .len   = 0,
+        .total = 0,
+        .flush = 0,
+    };
+    format(&out, fmt, ap);
+    if (size > 0) buf[out.len] = 0;
+    return out.total;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int ksnprintf(char* buf, size_t size, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int nb = kvsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return nb;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int kvprintf(const char* fmt, va_list ap) {
+    char          buf[CONSOLE_BUFFER_SIZE];
+    struct output out = {
+        .buf   = buf,
+        .size  = sizeof(buf),
+        .len   = 0,
+        .total = 0,
+        .flush = console_flush,
+    };
+    format(&out, fmt, ap);
+    console_flush(&out);
+    return out.total;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int kprintf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int nb = kvprintf(fmt, ap);
+    va_end(ap);
+    return nb;
+}
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Decoder of the deferred binary log frames produced by dlog.c
+
+The format strings are read from the .dlog_fmt section of the application
+ELF file, the frames from a serial port or a capture file.
+
+usage: dlog_decode.py app.elf capture.bin
+       dlog_decode.py app.elf /dev/ttyUSB0 --baudrate 115200
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+FRAME_HEADER_SIZE = 10
+MAX_ARGS = 8
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+class Elf:
+    """minimal ELF reader: allocated sections and their content"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] not in (1, 2):
+            raise ValueError(f"{path}: not an ELF file")
+        self.endian = "<" if self.data[5] == 1 else ">"
+        # word size dependent layouts (ELF32 or ELF64, e.g. host builds)
+        w = "I" if self.data[4] == 1 else "Q"
+        ehdr = self.endian + "16xHHI" + w * 3 + "IHHHHHH"
+        shdr = self.endian + "II" + w * 4 + "II" + w * 2
+
+        hdr = struct.unpack_from(ehdr, self.data)
+        shoff, shentsize, shnum, shstrndx = hdr[5], hdr[10], hdr[11], hdr[12]
+
+        sections = []
+        for i in range(shnum):
+            sh = struct.unpack_from(shdr, self.data, shoff + i * shentsize)
+            sections.append(sh)
+        strtab = sections[shstrndx]
+
+        self.sections = {}
+        for sh in sections:
+            name_off = strtab[4] + sh[0]
+            name = self.data[name_off:self.data.index(b"\0", name_off)]
+            self.sections[name.decode()] = {
+                "type": sh[1], "flags": sh[2], "addr": sh[3],
+                "offset": sh[4], "size": sh[5],
+            }
+
+    def read_string(self, addr):
+        """return the zero terminated string located at a target address"""
+        for sec in self.sections.values():
+            if not sec["flags"] & SHF_ALLOC or sec["type"] == SHT_NOBITS:
+                continue
+            if sec["addr"] <= addr < sec["addr"] + sec["size"]:
+                start = sec["offset"] + addr - sec["addr"]
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode(errors="replace")
+        return None
+
+
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\d+))?(hh|h|ll|l|j|z|t)?([diouxXcsp%])")
+
+
+def render(elf, fmt, args):
+    """format the arguments with a C printf format string"""
+    args = list(args)
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            width = str(struct.unpack("i", struct.pack("I", args.pop(0)))[0])
+        value = args.pop(0) if args else 0
+        spec = "%" + flags + (width or "")
+        if precision is not None:
+            spec += "." + precision
+        if conv in "di":
+            return (spec + "d") % struct.unpack("i", struct.pack("I", value))[0]
+        if conv == "u":
+            return (spec + "d") % value
+        if conv in "oxX":
+            return (spec + conv) % value
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "p":
+            return "%s0x%08x" % (flags.replace("0", ""), value)
+        s = elf.read_string(value)
+        return (spec + "s") % (s if s is not None else f"<0x{value:08x}>")
+
+    return SPEC.sub(convert, fmt)
+
+
+def frames(read, endian):
+    """extract the frames from the byte stream, resynchronizing on errors"""
+    buf = b""
+    while True:
+        chunk = read()
+        if not chunk:
+            return
+        buf += chunk
+        while len(buf) >= FRAME_HEADER_SIZE:
+            if buf[0] != FRAME_SYNC or buf[1] > MAX_ARGS:
+                buf = buf[1:]
+                continue
+            size = FRAME_HEADER_SIZE + 4 * buf[1]
+            if len(buf) < size:
+                break
+            words = struct.unpack_from(endian + "%dI" % (2 + buf[1]), buf, 2)
+            yield words[0], words[1], words[2:], buf[:size]
+            buf = buf[size:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="application ELF file")
+    parser.add_argument("input", help="capture file or serial port")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--frequency", type=float, default=24e6,
+                        help="DMTimer1 clock frequency in Hz")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    sec = elf.sections.get(".dlog_fmt")
+    if sec is None:
+        sys.exit(f"{args.elf}: no .dlog_fmt section")
+    lo, hi = sec["addr"], sec["addr"] + sec["size"]
+
+    if args.input.startswith("/dev/"):
+        import serial
+        port = serial.Serial(args.input, args.baudrate)
+        read = lambda: port.read(max(1, port.in_waiting))
+    else:
+        capture = open(args.input, "rb")
+        read = lambda: capture.read(4096)
+
+    t0 = None
+    for fmt_addr, timestamp, values, _ in frames(read, elf.endian):
+        if t0 is None:
+            t0 = timestamp
+        t = ((timestamp - t0) & 0xFFFFFFFF) / args.frequency
+        if fmt_addr == 0:
+            print(f"[{t:12.6f}] *** {values[0]} frame(s) lost ***")
+        elif lo <= fmt_addr < hi:
+            print(f"[{t:12.6f}] " + render(elf, elf.read_string(fmt_addr), values))
+        else:
+            print(f"[{t:12.6f}] *** unknown format 0x{fmt_addr:08x} ***")
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()